@@ -1,46 +1,41 @@
 #include "BaseAlgorithm.h"
 
-BaseAlgorithm::BaseAlgorithm(){
-    // Init the errorCodeBits vector, consider moving to the constructor
-    errorCodeBits.push_back(1);
-    for(int i = 1; i < NUM_OF_ERROR_CODES; i++){
-        errorCodeBits.push_back(errorCodeBits[i-1]*2);
-    }
+int BaseAlgorithm::setParsedInput(const ParsedInput &input) {
+    parsedInput = &input;
+    return 0;
 }
 
 int BaseAlgorithm::readShipPlan(const std::string &full_path_and_file_name) {
+    shipValid = true;
+    shipErrorCode = 0;
+    if(parsedInput) { // Validated by the simulator, it runs only valid plans
+        ship = parsedInput->getShipPlan();
+        return parsedInput->getShipPlanErrors();
+    }
     ship.resetShipPlan();
 
-    shipValid = true;
-    vector<pair<int,string>> err_msgs;
-    ship.initShipPlanFromFile(full_path_and_file_name, err_msgs, shipValid);
+    FlagsSink errors; // Only the flags are returned, so the messages are not built
+    ship.initShipPlanFromFile(full_path_and_file_name, errors, shipValid);
 
-    //Check for errors
-    int errorsFlags = 0;
-    for(auto& p : err_msgs){
-        errorsFlags |= errorCodeBits[p.first];
-    }
-    shipErrorCode = 0;
     if(!shipValid)
-        shipErrorCode = errorsFlags;
-    return errorsFlags;
+        shipErrorCode = errors.flags;
+    return errors.flags;
 }
 
 int BaseAlgorithm::readShipRoute(const std::string &full_path_and_file_name) {
-    route = Route();
-    vector<pair<int,string>> errors;
     routeValid = true;
+    routeErrorCode = 0;
+    if(parsedInput) { // Validated by the simulator, it runs only valid routes
+        route = parsedInput->getRoute();
+        return parsedInput->getRouteErrors();
+    }
+    route = Route();
+    FlagsSink errors;
     route.initRouteFromFile(full_path_and_file_name, errors, routeValid);
 
-    //Check for errors
-    int errorsFlags = 0;
-    for(auto& p : errors){
-        errorsFlags |= errorCodeBits[p.first];
-    }
-    routeErrorCode = 0;
     if(!routeValid)
-        routeErrorCode = errorsFlags;
-    return errorsFlags;
+        routeErrorCode = errors.flags;
+    return errors.flags;
 }
 
 int BaseAlgorithm::setWeightBalanceCalculator(WeightBalanceCalculator &calculator) {
@@ -49,72 +44,77 @@ int BaseAlgorithm::setWeightBalanceCalculator(WeightBalanceCalculator &calculato
 }
 
 int BaseAlgorithm::getInstructionsForCargo(const std::string &input_full_path_and_file_name, const std::string &output_full_path_and_file_name) {
-    if(!shipValid){
-        FileHandler emptyFile(output_full_path_and_file_name, true); // Create empty instructions file
-        return shipErrorCode;
-    }
-    if(!routeValid){
-        FileHandler emptyFile(output_full_path_and_file_name, true); // Create empty instructions file
+    InstructionsFile instructionsFile(output_full_path_and_file_name); // Created even if there are no instructions
+    return sendInstructionsForCargo(input_full_path_and_file_name, instructionsFile);
+}
+
+int BaseAlgorithm::sendInstructionsForCargo(const std::string &input_full_path_and_file_name, InstructionsSink &instructions) {
+    if(!shipValid)
+        return shipErrorCode; // No instructions
+    if(!routeValid)
         return routeErrorCode;
-    }
-    vector<pair<int,string>> errors;
+    FlagsSink errors;
     route.moveToNextPortWithoutContInit();
-    if(!route.hasNextPort() &route.checkLastPortContainers(input_full_path_and_file_name, false)) { // This is the last port and it has waiting containers
-        errors.emplace_back(17, "Last port shouldn't has waiting containers");
-    } else {
-        route.getCurrentPort().initWaitingContainers(input_full_path_and_file_name, errors, ship, route.getLeftPortsNames());
-    }
+    loadPortCargo(input_full_path_and_file_name, errors);
     vector<Container>& waitingContainers = route.getCurrentPort().getWaitingContainers();
     vector<Container*> reloadContainers;
-    FileHandler instructionsFile(output_full_path_and_file_name, true);
 
     // Sort incoming containers by their destination
     route.sortContainersByDestination(waitingContainers);
 
     // Get Unload instructions for containers with destination equals to this port
-    getUnloadInstructions(route.getCurrentPort().getName(), reloadContainers, instructionsFile);
+    getUnloadInstructions(route.getCurrentPort().getName(), reloadContainers, instructions);
 
     // Get reload instructions for the reload containers
-    getReloadInstructions(reloadContainers, instructionsFile);
+    getReloadInstructions(reloadContainers, instructions);
 
     bool fullError = false;
     for (auto & cont : waitingContainers) {
         if(!cont.isValid()){
             // Illegal container, reject
-            instructionsFile.writeInstruction("R", cont.getID(), -1, -1, -1);
+            instructions.addInstruction(Action::REJECT, cont.getID(), -1, -1, -1);
             continue;
         }
         if (cont.getDestPort() == route.getCurrentPort().getName()) {
             // Destination is the current port, reject
-            instructionsFile.writeInstruction("R", cont.getID(), -1, -1, -1);
+            instructions.addInstruction(Action::REJECT, cont.getID(), -1, -1, -1);
             continue;
         }
         if (!route.isInRoute(cont.getDestPort())) {
             // Destination is not in the route, reject
-            instructionsFile.writeInstruction("R", cont.getID(), -1, -1, -1);
+            instructions.addInstruction(Action::REJECT, cont.getID(), -1, -1, -1);
             continue;
         }
-        bool notFull = findLoadingSpot(&cont, instructionsFile);
+        bool notFull = findLoadingSpot(&cont, instructions);
         if(!notFull && !fullError){
             fullError = true;
-            errors.emplace_back(18,"Ship is full, rejecting far containers");
+            errors.add(18, [] { return "Ship is full, rejecting far containers"; });
         }
         // Reject duplicate containers
         for(int i = 0; i < route.getCurrentPort().getNumOfDuplicates(cont.getID()); i++){
-            instructionsFile.writeInstruction("R", cont.getID(), -1, -1, -1);
+            instructions.addInstruction(Action::REJECT, cont.getID(), -1, -1, -1);
         }
     }
 
-    //Check for errors
-    int errorsFlags = 0;
-    for(auto& p : errors){
-        errorsFlags |= errorCodeBits[p.first];
+    return errors.flags;
+}
+
+void BaseAlgorithm::loadPortCargo(const std::string &input_full_path_and_file_name, FlagsSink &errors) {
+    CargoFile readCargo;
+    const CargoFile *cargo = parsedInput ? parsedInput->getPortCargo(route.getCurrentPortNum()) : nullptr;
+    if(cargo == nullptr || cargo->path != input_full_path_and_file_name) { // Not parsed, read the file
+        readCargo = CargoFile(input_full_path_and_file_name);
+        cargo = &readCargo;
+    }
+    if(!route.hasNextPort() && !cargo->lines.empty()) { // This is the last port and it has waiting containers
+        errors.add(17, [] { return "Last port shouldn't has waiting containers"; });
+    } else {
+        route.getCurrentPort().initWaitingContainers(*cargo, errors, ship, route.getLeftPortsNames());
     }
-    return errorsFlags;
 }
 
 void BaseAlgorithm::getUnloadInstructions(const string &portName, vector<Container *> &reloadContainers,
-                                         FileHandler &instructionsFile) {
+                                         InstructionsSink &instructions) {
     Container *container_to_unload;
     // Iterate ship from top to the bottom
     for (int floor_num = ship.getNumOfDecks() - 1; floor_num >= 0; --floor_num) {
@@ -126,16 +126,16 @@ void BaseAlgorithm::getUnloadInstructions(const string &portName, vector<Contain
                 // Check if the container's port ID match the current port ID
                 if (portName == container_to_unload->getDestPort()) {
                     markRemoveContainers(*container_to_unload, *(container_to_unload->getSpotInFloor()),
-                                         reloadContainers, instructionsFile);
+                                         reloadContainers, instructions);
                 }
             }
         }
     }
 }
 
-void BaseAlgorithm::getReloadInstructions(vector<Container*>& reload_containers, FileHandler& instructionsFile) {
+void BaseAlgorithm::getReloadInstructions(vector<Container*>& reload_containers, InstructionsSink& instructions) {
     for (auto & reload_container : reload_containers) {
-        findLoadingSpot(reload_container, instructionsFile);
+        findLoadingSpot(reload_container, instructions);
     }
 }
 
@@ -158,12 +158,12 @@ Spot *BaseAlgorithm::getEmptySpot(int &returnFloorNum, int fromX, int fromY) {
     return nullptr;
 }
 
-bool BaseAlgorithm::findLoadingSpot(Container *cont, FileHandler &instructionsFile) {
+bool BaseAlgorithm::findLoadingSpot(Container *cont, InstructionsSink &instructions) {
     int floorNum;
     Spot *empty_spot = getEmptySpot(floorNum);
     if (empty_spot == nullptr) {
         //Ship is full, reject
-        instructionsFile.writeInstruction("R", cont->getID(), -1, -1, -1);
+        instructions.addInstruction(Action::REJECT, cont->getID(), -1, -1, -1);
         return false;
     }
     vector<Spot *> failedSpots; // All spots that returned form getEmptySpot but put the container will make the ship unbalance
@@ -174,8 +174,8 @@ bool BaseAlgorithm::findLoadingSpot(Container *cont, FileHandler &instructionsFi
         failedSpots.push_back(empty_spot);
         empty_spot = getEmptySpot(floorNum);
         if (empty_spot == nullptr) {
-            cout << "WARNING: No available spot for container: " << cont->getID() << endl;
-            instructionsFile.writeInstruction("R", cont->getID(), -1, -1, -1);
+            LOG_MESSAGE(logger, LogLevel::Warning, "WARNING: No available spot for container: " + cont->getID());
+            instructions.addInstruction(Action::REJECT, cont->getID(), -1, -1, -1);
             for (auto &spot : failedSpots)
                 spot->setAvailable(true);
             return true;
@@ -185,21 +185,21 @@ bool BaseAlgorithm::findLoadingSpot(Container *cont, FileHandler &instructionsFi
     for (auto &spot : failedSpots)
         spot->setAvailable(true);
     // Write loading instruction
-    instructionsFile.writeInstruction("L", cont->getID(), floorNum, empty_spot->getPlaceX(), empty_spot->getPlaceY());
+    instructions.addInstruction(Action::LOAD, cont->getID(), floorNum, empty_spot->getPlaceX(), empty_spot->getPlaceY());
     ship.insertContainer(empty_spot, *cont);
     return true;
 }
 
-bool BaseAlgorithm::checkMoveContainer(Container* cont, Spot& spot, FileHandler& instructionsFile) {
+bool BaseAlgorithm::checkMoveContainer(Container* cont, Spot& spot, InstructionsSink& instructions) {
     // Prevent warnings
     (void)cont;
     (void)spot;
-    (void)instructionsFile;
+    (void)instructions;
     return false; // Naive implementation no move allowed
 }
 
 void BaseAlgorithm::markRemoveContainers(Container &cont, Spot &spot, vector<Container *> &reload_containers,
-                                        FileHandler &instructionsFile) {
+                                        InstructionsSink &instructions) {
     int curr_floor_num = ship.getNumOfDecks() - 1;
     string curr_dest = cont.getDestPort();
     Spot *curr_spot;
@@ -214,10 +214,10 @@ void BaseAlgorithm::markRemoveContainers(Container &cont, Spot &spot, vector<Con
                                    curr_spot->getPlaceY()) != WeightBalanceCalculator::APPROVED) { // Check if removing this container will turn the ship out of balance.
             // TODO ex3: Handle error
         }
-        if(!checkMoveContainer(curr_spot->getContainer(), *curr_spot, instructionsFile)) {
+        if(!checkMoveContainer(curr_spot->getContainer(), *curr_spot, instructions)) {
             reload_containers.push_back(curr_spot->getContainer());
             // Add unload instruction, will be reloaded later
-            instructionsFile.writeInstruction("U", curr_spot->getContainer()->getID(), curr_floor_num, spot.getPlaceX(),
+            instructions.addInstruction(Action::UNLOAD, curr_spot->getContainer()->getID(), curr_floor_num, spot.getPlaceX(),
                                               spot.getPlaceY());
             ship.removeContainer(curr_spot);
         }
@@ -228,7 +228,7 @@ void BaseAlgorithm::markRemoveContainers(Container &cont, Spot &spot, vector<Con
         // TODO ex3: Handle error
     }
     // We have reached the container that has the same port ID destination. write unload instruction
-    instructionsFile.writeInstruction("U", spot.getContainer()->getID(), curr_floor_num, spot.getPlaceX(),
+    instructions.addInstruction(Action::UNLOAD, spot.getContainer()->getID(), curr_floor_num, spot.getPlaceX(),
                                       spot.getPlaceY());
     ship.removeContainer(&spot);
 }
\ No newline at end of file
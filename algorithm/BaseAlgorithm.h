@@ -11,14 +11,14 @@
 #include "../common/ShipPlan.h"
 #include "../interfaces/WeightBalanceCalculator.h"
 #include "../interfaces/AbstractAlgorithm.h"
+#include "../interfaces/AlgorithmExtensions.h"
 #include "../interfaces/AlgorithmRegistration.h"
+#include "../common/Logger.h"
 #include <map>
 
-#define NUM_OF_ERROR_CODES 19
-
 using std::map;
 
-class BaseAlgorithm : public AbstractAlgorithm{
+class BaseAlgorithm : public ParsedInputAlgorithm{
 protected:
     ShipPlan ship;
     bool shipValid = true; // Is ship created successfully
@@ -27,18 +27,25 @@ protected:
     bool routeValid = true; // Is route created successfully
     int routeErrorCode = 0; // last fatal error code in route init, 0 if there wasn't any
     WeightBalanceCalculator weightCal;
-    vector<int> errorCodeBits; // values for each error code bit
+    Logger &logger = Logger::getInstance(); // The simulator's logger
+    const ParsedInput *parsedInput = nullptr; // The travel's input parsed by the simulator, nullptr if the files are read
+
+    /**
+     * Load the containers waiting in the current port, from the parsed cargo file of the port if the simulator gave
+     * it, otherwise from the file in @param input_full_path_and_file_name
+     */
+    void loadPortCargo(const std::string &input_full_path_and_file_name, FlagsSink &errors);
 
     /**
      * Unload all the containers that their destination is portName
      * Also unload the containers above them and insert them to reload_containers vector
      */
-    virtual void getUnloadInstructions(const string &portName, vector<Container *> &reloadContainers, FileHandler &instructionsFile);
+    virtual void getUnloadInstructions(const string &portName, vector<Container *> &reloadContainers, InstructionsSink &instructions);
 
     /**
      * Reload all the containers that was unload to allow access to lower containers
      */
-    virtual void getReloadInstructions(vector<Container *> &reload_containers, FileHandler &instructionsFile);
+    virtual void getReloadInstructions(vector<Container *> &reload_containers, InstructionsSink &instructions);
 
     /**
      * Search for an empty spot in the ship for container loading
@@ -50,24 +57,24 @@ protected:
     /**
      * Load container to the ship, return false if ship is full
      */
-    virtual bool findLoadingSpot(Container *cont, FileHandler &instructionsFile);
+    virtual bool findLoadingSpot(Container *cont, InstructionsSink &instructions);
 
     /**
      * Check it's possible to use move instruction for @param cont from the ship (places in @param spot)
      * If it's possible, write move instruction in the instructions file
      * Return true if succeed and false if fails
      */
-    virtual bool checkMoveContainer(Container* cont, Spot& spot, FileHandler& instructionsFile);
+    virtual bool checkMoveContainer(Container* cont, Spot& spot, InstructionsSink& instructions);
 
     /**
      * Remove @param cont from the ship (places in @param spot)
      * Also Unload all the containers above it and insert them in reloadContainers
      */
     virtual void markRemoveContainers(Container &cont, Spot &spot, vector<Container *> &reload_containers,
-                                      FileHandler &instructionsFile);
+                                      InstructionsSink &instructions);
 
 public:
-    BaseAlgorithm();
+    BaseAlgorithm() = default;
     /**
      *  Fill the instructions file with the instructions that need to do in this port.
      *  Get the containers to be loaded in this port from the input file
@@ -75,12 +82,23 @@ public:
     int getInstructionsForCargo(const std::string &input_full_path_and_file_name, const std::string &output_full_path_and_file_name) override;
 
     /**
-     * Read the ship plan from the given file
+     *  Send the instructions that need to do in this port to the simulator's sink, in memory.
+     *  Get the containers to be loaded in this port from the input file
+     */
+    int sendInstructionsForCargo(const std::string &input_full_path_and_file_name, InstructionsSink &instructions) override;
+
+    /**
+     * Keep the travel's input that the simulator parsed, the ship plan, the route and the cargo are taken from it
+     */
+    int setParsedInput(const ParsedInput &input) override;
+
+    /**
+     * Read the ship plan from the given file (or take it from the parsed input)
      */
     int readShipPlan(const std::string &full_path_and_file_name) override;
 
     /**
-     * Read the ship route from the given file
+     * Read the ship route from the given file (or take it from the parsed input)
      */
     int readShipRoute(const std::string &full_path_and_file_name) override;
 
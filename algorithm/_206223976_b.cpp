@@ -1,11 +1,11 @@
 #include "_206223976_b.h"
 REGISTER_ALGORITHM(_206223976_b)
 
-bool _206223976_b::checkMoveContainer(Container *cont, Spot &spot, FileHandler &instructionsFile) {
+bool _206223976_b::checkMoveContainer(Container *cont, Spot &spot, InstructionsSink &instructions) {
     int floorNum;
     Spot* emptySpot = getEmptySpot(floorNum, spot.getPlaceX(), spot.getPlaceY());
     if(emptySpot != nullptr){
-        instructionsFile.writeInstruction("M", cont->getID(), spot.getFloorNum(), spot.getPlaceX(),
+        instructions.addInstruction(Action::MOVE, cont->getID(), spot.getFloorNum(), spot.getPlaceX(),
                 spot.getPlaceY(), floorNum, emptySpot->getPlaceX(), emptySpot->getPlaceY());
         ship.moveContainer(spot.getFloorNum(), spot.getPlaceX(),
                            spot.getPlaceY(), floorNum, emptySpot->getPlaceX(), emptySpot->getPlaceY());
@@ -11,7 +11,7 @@
 class _206223976_b : public BaseAlgorithm {
 
 protected:
-    bool checkMoveContainer(Container *cont, Spot &spot, FileHandler &instructionsFile) override;
+    bool checkMoveContainer(Container *cont, Spot &spot, InstructionsSink &instructions) override;
 };
 
 #endif //SHIPPROJECT__206223976_B_H
@@ -12,7 +12,7 @@
 class _206223976_c : public BaseAlgorithm {
 
 protected:
-    void markRemoveContainers(Container &cont, Spot &spot, vector<Container *> &reload_containers, FileHandler &instructionsFile) override;
+    void markRemoveContainers(Container &cont, Spot &spot, vector<Container *> &reload_containers, InstructionsSink &instructions) override;
 
-    int getInstructionsForCargo(const std::string &input_full_path_and_file_name, const std::string &output_full_path_and_file_name) override;
+    int sendInstructionsForCargo(const std::string &input_full_path_and_file_name, InstructionsSink &instructions) override;
 };
\ No newline at end of file
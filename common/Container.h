@@ -50,7 +50,7 @@ public:
 
     string getDestPort() const;
 
-    string getID() {
+    const string &getID() const {
         return this->id;
     }
 
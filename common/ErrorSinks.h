@@ -0,0 +1,39 @@
+/**
+ * The error sinks of the input files parsers. A parser reports each error by its code and a function that builds its
+ * message, and the sink it's given decides what's kept: the simulator keeps the messages, an algorithm needs only the
+ * flags of the codes, so it never builds a message.
+ */
+
+#ifndef SHIPPROJECT_ERRORSINKS_H
+#define SHIPPROJECT_ERRORSINKS_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Keeps the code and the message of each error, by their order.
+ */
+struct MessagesSink {
+    std::vector<std::pair<int, std::string>> &errors;
+
+    template<typename MessageBuilder>
+    void add(int code, MessageBuilder &&buildMessage) {
+        errors.emplace_back(code, buildMessage());
+    }
+};
+
+/**
+ * Folds the codes of the errors into flags, bit i is set if an error with code i has occurred.
+ */
+struct FlagsSink {
+    int flags = 0;
+
+    template<typename MessageBuilder>
+    void add(int code, MessageBuilder &&) {
+        if (code >= 0) // Negative codes are reported to the simulator only, they have no flag
+            flags |= 1 << code;
+    }
+};
+
+#endif //SHIPPROJECT_ERRORSINKS_H
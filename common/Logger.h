@@ -0,0 +1,105 @@
+/**
+ * The logger class, prints the diagnostics of the simulator and of the algorithms without holding up their threads.
+ * Each thread that logs owns a ring buffer of its own, which it fills without locks, and a background thread drains
+ * all of the rings to the standard output. Until the background thread is started (and after it's stopped) a message
+ * is printed right away, as in a forked worker process.
+ * The logger belongs to the simulator, the algorithms reach it with getInstance() like they reach the registration.
+ * A message below the logger's level costs a single relaxed load, use LOG_MESSAGE so it isn't even built.
+ */
+
+#ifndef SHIPPROJECT_LOGGER_H
+#define SHIPPROJECT_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_RING_SIZE 256 // Messages a thread may log before the background thread drains them
+
+/**
+ * Logs @param message (an expression that gives a string) at the given level, the message is built only if the
+ * level is enabled.
+ */
+#define LOG_MESSAGE(logger, level, message) \
+    do { if ((logger).isEnabled(level)) (logger).log(level, message); } while (false)
+
+enum class LogLevel : int {
+    Debug, Info, Warning, Error, Off
+};
+
+class Logger {
+private:
+    // A single producer, single consumer ring of a logging thread
+    struct Ring {
+        std::string messages[LOG_RING_SIZE]; // Their buffers are kept for the next messages, so they hardly allocate
+        std::atomic<size_t> head{0}; // The next entry to drain, advanced only by a drain, under ringsMutex
+        std::atomic<size_t> tail{0}; // The next entry to fill, advanced only by the owner thread
+    };
+
+    std::atomic<int> level{(int) LogLevel::Info};
+    std::atomic_bool running{false};
+    std::mutex ringsMutex; // Guards the list of rings, taken once by each thread that logs
+    std::vector<std::unique_ptr<Ring>> rings; // Kept after their thread ends, the logger may still drain them
+    std::mutex outputMutex; // Messages that are printed right away don't interleave
+    std::mutex drainMutex;
+    std::condition_variable drainCond;
+    bool stopping = false; // Guarded by drainMutex
+    std::thread drainer;
+
+    static thread_local Ring *threadRing;
+
+    /**
+     * Returns the ring of the current thread, creating it if it's the thread's first message.
+     */
+    Ring &getThreadRing();
+
+    /**
+     * Prints the messages of all of the rings, returns false if there were none. The drains are serialized by
+     * ringsMutex, so a thread that logged while the logger stopped may drain as well.
+     */
+    bool drain();
+
+    void drainerFunc();
+
+    void printNow(const std::string &message);
+
+    Logger() = default;
+
+public:
+    Logger(const Logger &other) = delete;
+
+    Logger &operator=(const Logger &other) = delete;
+
+    ~Logger();
+
+    static Logger &getInstance();
+
+    void setLevel(LogLevel newLevel) {
+        level.store((int) newLevel, std::memory_order_relaxed);
+    }
+
+    bool isEnabled(LogLevel messageLevel) const {
+        return (int) messageLevel >= level.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Logs the given message. May be called from any thread, it waits only if the thread's ring is full.
+     */
+    void log(LogLevel messageLevel, const std::string &message);
+
+    /**
+     * Starts the background thread. Must not be called before forking worker processes.
+     */
+    void start();
+
+    /**
+     * Prints the messages that are left and stops the background thread.
+     */
+    void stop();
+};
+
+#endif //SHIPPROJECT_LOGGER_H
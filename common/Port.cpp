@@ -1,4 +1,5 @@
 #include "Port.h"
+#include <deque>
 
 Port::Port(const string &name) {
     if (!validateName(name)) {
@@ -40,84 +41,165 @@ bool isInNextPorts(const string& port, const vector<string>& nextPorts){
     return false;
 }
 
-void Port::initWaitingContainers(const string &path, vector<pair<int,string>>& errVector, const ShipPlan& ship, const vector<string>& nextPorts) {
+CargoFile::CargoFile(const string &path) : path(path) {
     FileHandler fh(path);
-    string id = "";
-    if (fh.isFailed()){
-        errVector.emplace_back(16,"Failed to open " + path + " considered as no containers waiting");
+    if (fh.isFailed()) {
+        failed = true;
         return;
     }
     vector<string> tokens;
     while (fh.getNextLineAsTokens(tokens)) {
+        CargoLine &line = lines.emplace_back();
+        line.tokens = tokens;
+        if (tokens.empty())
+            continue;
+        line.validId = Container::validateID(tokens[0]);
+        if (tokens.size() >= 2)
+            line.weight = isPositiveNumber(tokens[1]) ? stoi(tokens[1]) : ILLEGAL_WEIGHT;
+        if (tokens.size() >= 3)
+            line.validDest = Port::validateName(tokens[2]);
+    }
+}
+
+template<typename ErrorSink>
+void Port::initWaitingContainers(const CargoFile &cargo, ErrorSink& errs, const ShipPlan& ship, const vector<string>& nextPorts) {
+    if (cargo.failed){
+        errs.add(16, [&cargo] { return "Failed to open " + cargo.path + " considered as no containers waiting"; });
+        return;
+    }
+    // The containers that were read, an existing container that is replaced is only marked erased (and removed at
+    // the end), so the indexes of the others are kept while reading
+    vector<bool> erased(waitingContainers.size(), false);
+    std::unordered_map<string, std::deque<int>> loadedById; // ID -> indexes of the containers with it that aren't erased
+    for (int i = 0; i < (int) waitingContainers.size(); i++)
+        loadedById[waitingContainers[i].getID()].push_back(i);
+    for (const CargoLine &line : cargo.lines) {
+        const vector<string> &tokens = line.tokens;
         bool valid = true;
         if (tokens.empty()) {
-            errVector.emplace_back(14,"ID cannot be read");
+            errs.add(14, [] { return "ID cannot be read"; });
             continue;
+        }
+        const string &id = tokens[0];
+        if (!line.validId) {
+            errs.add(15, [&id] { return "Illegal ID for container: " + id; });
+            valid = false;
         } else {
-            id = tokens[0];
-            if (!Container::validateID(id)) {
-                errVector.emplace_back(15, "Illegal ID for container: " + id);
+            if (ship.isContOnShip(id)) { // Check that there isn't already container with the same ID on the ship
+                errs.add(11, [&id] { return "Container with ID " + id + " already loaded on the ship"; });
                 valid = false;
             } else {
-                if (ship.isContOnShip(id)) { // Check that there isn't already container with the same ID on the ship
-                    errVector.emplace_back(11, "Container with ID " + id + " already loaded on the ship");
-                    valid = false;
-                } else {
-                    // Check that there isn't already container with the same ID in the port
-                    bool dup = false;
-                    for (auto it = waitingContainers.begin(); it != waitingContainers.end(); it++) {
-                        if (id == (*it).getID()) {
-                            errVector.emplace_back(10, "Container with ID: " + id + " already exists in port: " + name);
-                            if ((*it).isValid() && (*it).getDestPort() != name && isInNextPorts((*it).getDestPort(), nextPorts)) {
-                                // Valid container with same ID, mark this one as duplicate
-                                dup = true;
-                            } else {
-                                waitingContainers.erase(it); // remove existing invalid container
-                            }
-                            if (duplicateIdOnPort.find(id) != duplicateIdOnPort.end()) {
-                                duplicateIdOnPort[id]++; // add one more duplicate
-                            } else {
-                                duplicateIdOnPort[id] = 1; // first duplicate
-                            }
-                            break;
-                        }
+                // Check that there isn't already container with the same ID in the port
+                bool dup = false;
+                auto existing = loadedById.find(id);
+                if (existing != loadedById.end() && !existing->second.empty()) {
+                    Container &first = waitingContainers[existing->second.front()];
+                    errs.add(10, [this, &id] { return "Container with ID: " + id + " already exists in port: " + name; });
+                    if (first.isValid() && first.getDestPort() != name && isInNextPorts(first.getDestPort(), nextPorts)) {
+                        // Valid container with same ID, mark this one as duplicate
+                        dup = true;
+                    } else {
+                        erased[existing->second.front()] = true; // remove existing invalid container
+                        existing->second.pop_front();
+                    }
+                    if (duplicateIdOnPort.find(id) != duplicateIdOnPort.end()) {
+                        duplicateIdOnPort[id]++; // add one more duplicate
+                    } else {
+                        duplicateIdOnPort[id] = 1; // first duplicate
                     }
-                    if(dup) // A duplicate container, already added to the duplicate map
-                        continue;
                 }
+                if(dup) // A duplicate container, already added to the duplicate map
+                    continue;
             }
         }
-        int weight = 0;
         if (tokens.size() < 2){
-            errVector.emplace_back(12,"No weight given for container: " + id + " - container rejected");
-            weight = NO_WEIGHT;
+            errs.add(12, [&id] { return "No weight given for container: " + id + " - container rejected"; });
+            valid = false;
+        } else if (line.weight == ILLEGAL_WEIGHT) {
+            errs.add(12, [&tokens, &id] {
+                return "Illegal weight given for container: " + tokens[1] + " Container " + id + " rejected";
+            });
             valid = false;
-        } else {
-            if (isPositiveNumber(tokens[1])) {
-                weight = stoi(tokens[1]);
-            } else {
-                errVector.emplace_back(12,"Illegal weight given for container: " + tokens[1] + " Container " + id + " rejected");
-                weight = ILLEGAL_WEIGHT;
-                valid = false;
-            }
         }
         string dest;
         if (tokens.size() < 3) {
-            errVector.emplace_back(13,"No destination port given for container: " + id + " - container rejected");
+            errs.add(13, [&id] { return "No destination port given for container: " + id + " - container rejected"; });
             valid = false;
         } else {
             dest = tokens[2];
-            if (!Port::validateName(dest)) {
-                errVector.emplace_back(13,"Illegal destination given for container: " + dest + " Container " + id + " rejected");
+            if (!line.validDest) {
+                errs.add(13, [&dest, &id] {
+                    return "Illegal destination given for container: " + dest + " Container " + id + " rejected";
+                });
                 valid = false;
             }
         }
-        waitingContainers.emplace_back(weight, Port::nameToUppercase(dest), id, valid);
+        waitingContainers.emplace_back(line.weight, Port::nameToUppercase(dest), id, valid);
+        erased.push_back(false);
+        loadedById[id].push_back((int) waitingContainers.size() - 1);
+    }
+    if (std::find(erased.begin(), erased.end(), true) != erased.end()) {
+        vector<Container> kept;
+        kept.reserve(waitingContainers.size());
+        for (int i = 0; i < (int) waitingContainers.size(); i++) {
+            if (!erased[i])
+                kept.push_back(std::move(waitingContainers[i]));
+        }
+        waitingContainers = std::move(kept);
+    }
+    indexWaitingContainers();
+}
+
+template void Port::initWaitingContainers<MessagesSink>(const CargoFile&, MessagesSink&, const ShipPlan&,
+                                                        const vector<string>&);
+
+template void Port::initWaitingContainers<FlagsSink>(const CargoFile&, FlagsSink&, const ShipPlan&, const vector<string>&);
+
+void Port::shareWaitingContainers() {
+    if (sharedContainers)
+        return;
+    sharedContainers = std::make_shared<const vector<Container>>(std::move(waitingContainers));
+    waitingContainers.clear();
+}
+
+void Port::materializeWaitingContainers() {
+    if (!sharedContainers)
+        return;
+    waitingContainers = *sharedContainers;
+    sharedContainers.reset();
+}
+
+void Port::indexWaitingContainers() {
+    const vector<Container> &containers = sharedContainers ? *sharedContainers : waitingContainers;
+    auto index = std::make_shared<ContainersIndex>();
+    index->reserve(containers.size());
+    for (int i = 0; i < (int) containers.size(); i++)
+        (*index)[containers[i].getID()].push_back(i);
+    containersIndex = std::move(index);
+}
+
+void Port::invalidateContainersOnShip(const ShipPlan &ship) {
+    for (auto &cont : waitingContainers) {
+        if (ship.isContOnShip(cont.getID()))
+            cont.invalidateContainer();
     }
 }
 
 Container* Port::getWaitingContainerByID(const string &id, bool skipInvalid) {
-    return Port::getContainerByIDFrom(waitingContainers, id, skipInvalid);
+    if (waitingContainers.empty()) // Nothing is waiting, or the containers are still shared
+        return nullptr;
+    if (!containersIndex)
+        indexWaitingContainers();
+    auto found = containersIndex->find(id);
+    if (found == containersIndex->end())
+        return nullptr; // didn't find the container
+    for (int i : found->second) {
+        Container &container = waitingContainers[i];
+        if (skipInvalid && !container.isValid())
+            continue;
+        return &container; // found the container
+    }
+    return nullptr;
 }
 
 Container* Port::getContainerByIDFrom(vector<Container>& containers, const string &id, bool skipInvalid) {
@@ -150,12 +232,7 @@ ostream &operator<<(ostream &os, const Port &p) {
 bool Port::isDuplicateOnPort(Container &cont){
     if(cont.isValid())
         return false;
-    for(auto& c : waitingContainers){
-        if(cont.getID() == c.getID() && c.isValid()){
-            return true;
-        }
-    }
-    return false;
+    return getWaitingContainerByID(cont.getID(), true) != nullptr;
 }
 
 int Port::getNumOfDuplicates(const string &id) {
@@ -10,11 +10,14 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <cctype>
+#include <memory>
 #include "Container.h"
 #include "Utils.h"
 #include "algorithm"
 #include "ShipPlan.h"
+#include "ErrorSinks.h"
 
 using std::pair;
 using std::map;
@@ -23,13 +26,50 @@ using std::map;
 #define PORT_NAME_LEN 5
 #define INVALID "Invalid"
 
+/**
+ * A line of a cargo file, with the checks that depend on the line alone
+ */
+struct CargoLine {
+    vector<string> tokens; // The fields of the line, the messages of its errors quote them
+    bool validId = false; // Is the first field a legal container ID
+    int weight = NO_WEIGHT; // The weight in the second field, NO_WEIGHT if it's missing and ILLEGAL_WEIGHT if illegal
+    bool validDest = false; // Is the third field a legal port code
+};
+
+/**
+ * The lines of a cargo file, read once and then loaded to the port by any number of ships
+ */
+struct CargoFile {
+    string path; // The path it was read from
+    bool failed = false; // Failed opening the file, it has no lines
+    vector<CargoLine> lines; // Its lines that are not empty or comments, by their order
+
+    CargoFile() = default;
+
+    /**
+     * Read the file locate in @param path
+     */
+    explicit CargoFile(const string &path);
+};
+
 //---Main class---//
 class Port {
 private:
     string name; // 5 letters represents the port code
     vector<Container> waitingContainers; // Containers waiting in this port to be loaded to the ship
+    std::shared_ptr<const vector<Container>> sharedContainers; // Read only waiting containers, shared between copies
+                                                               // of the port until the ship arrives to it
     map<string, int> duplicateIdOnPort; // map from id to the number of duplicates on the port
                                         // (value of 1 means total of 2 containers with this id)
+    typedef std::unordered_map<string, vector<int>> ContainersIndex; // ID -> indexes of the waiting containers with
+                                                                      // this ID, by their order
+    std::shared_ptr<const ContainersIndex> containersIndex; // Built once the containers are loaded, shared between
+                                                            // copies of the port like the containers
+
+    /**
+     * Build the index of the waiting containers (or of the shared ones, their order is the same)
+     */
+    void indexWaitingContainers();
 
 public:
     //---Constructors and Destructors---//
@@ -44,19 +84,67 @@ public:
      */
     static bool validateName(const string &name);
 
+    /**
+     * The caller may reorder the containers, so the index of their IDs is rebuilt on the next search
+     */
     vector<Container>& getWaitingContainers() {
+        containersIndex.reset();
+        return waitingContainers;
+    }
+
+    const vector<Container>& getWaitingContainers() const {
         return waitingContainers;
     }
 
+    int getNumOfWaitingContainers() const {
+        return (int) (sharedContainers ? sharedContainers->size() : waitingContainers.size());
+    }
+
+    /**
+     * Move the waiting containers to a read only vector, so copies of the port share it instead of copying it
+     */
+    void shareWaitingContainers();
+
+    /**
+     * Copy the shared waiting containers (if there are) into the port's own vector, before they are changed
+     */
+    void materializeWaitingContainers();
+
+    /**
+     * Invalidate the waiting containers that are already on the ship, their order (and index) is kept
+     */
+    void invalidateContainersOnShip(const ShipPlan& ship);
+
+    /**
+     * Initialize the waiting containers vector from the lines of the given cargo file
+     * @param errs: the sink of the errors that occurs (a MessagesSink or a FlagsSink)
+     */
+    template<typename ErrorSink>
+    void initWaitingContainers(const CargoFile &cargo, ErrorSink& errs, const ShipPlan& ship, const vector<string>& nextPorts);
+
     /**
      * Read the file locate in @param path to initialize the waiting containers vector
-     * @param errVector filled with errors that occurs
+     * @param errs: the sink of the errors that occurs (a MessagesSink or a FlagsSink)
      */
-    void initWaitingContainers(const string &path, vector<pair<int,string>>& errVector, const ShipPlan& ship, const vector<string>& nextPorts);
+    template<typename ErrorSink>
+    void initWaitingContainers(const string &path, ErrorSink& errs, const ShipPlan& ship, const vector<string>& nextPorts) {
+        initWaitingContainers(CargoFile(path), errs, ship, nextPorts);
+    }
+
+    void initWaitingContainers(const string &path, vector<pair<int,string>>& errVector, const ShipPlan& ship, const vector<string>& nextPorts) {
+        MessagesSink errs{errVector};
+        initWaitingContainers(path, errs, ship, nextPorts);
+    }
+
+    void initWaitingContainers(const CargoFile &cargo, vector<pair<int,string>>& errVector, const ShipPlan& ship, const vector<string>& nextPorts) {
+        MessagesSink errs{errVector};
+        initWaitingContainers(cargo, errs, ship, nextPorts);
+    }
 
     /**
      * @param skipInvalid: true if the search is among valid containers only
      * Return the container with id equals to @param id or nullptr if there is not one like that
+     * Takes constant time, the containers are searched by their index
      */
     Container* getWaitingContainerByID(const string &id, bool skipInvalid = true);
 
@@ -4,37 +4,42 @@ Route::Route(const string &path, vector<pair<int,string>>& errVector, bool& succ
     initRouteFromFile(path, errVector, success);
 }
 
-void Route::initRouteFromFile(const string& path, vector<pair<int,string>>& errVector, bool& success) {
+template<typename ErrorSink>
+void Route::initRouteFromFile(const string& path, ErrorSink& errs, bool& success) {
     FileHandler fh(path);
     if(fh.isFailed()){
-        errVector.emplace_back(7,"Error while opening route file- can't run this travel");
+        errs.add(7, [] { return "Error while opening route file- can't run this travel"; });
         success = false;
     }
     string name;
     string prevName;
     while(fh.getNextLine(name)){
         if(name == prevName){
-            errVector.emplace_back(5,"Port " + name + " Appeared twice in a row - second time ignored");
+            errs.add(5, [&name] { return "Port " + name + " Appeared twice in a row - second time ignored"; });
         } else {
             if(Port::validateName(name)) {
                 ports.emplace_back(name);
                 portVisits[name] = 0;
             } else {
-                errVector.emplace_back(6,"Illegal name for port: " + name + " port ignored");
+                errs.add(6, [&name] { return "Illegal name for port: " + name + " port ignored"; });
             }
         }
         prevName = name;
     }
     if((int)ports.size() < 1){
-        errVector.emplace_back(8,"Illegal Route file given - empty file - can't run this travel");
+        errs.add(8, [] { return "Illegal Route file given - empty file - can't run this travel"; });
         success = false;
     } else if((int)ports.size() < 2){
-        errVector.emplace_back(8,"Illegal Route file given - less then two valid ports in route - can't run this travel");
+        errs.add(8, [] { return "Illegal Route file given - less then two valid ports in route - can't run this travel"; });
         success = false;
     }
     empty_file = string(".") + std::filesystem::path::preferred_separator + string("empty_file");
 }
 
+template void Route::initRouteFromFile<MessagesSink>(const string&, MessagesSink&, bool&);
+
+template void Route::initRouteFromFile<FlagsSink>(const string&, FlagsSink&, bool&);
+
 /**
  * Compare two port's path for the sort in initPortsContainer
  * First compare the port code and sort alphabetically, second compare the number part, sort from small to big
@@ -51,9 +56,13 @@ bool portPathsCompare(const string& s1, const string& s2) {
     }
 }
 
-void Route::initPorts(const string &dir, vector<string> &paths, vector<pair<int, string> > &errVector, const ShipPlan& ship) {
+void Route::initPorts(const string &dir, vector<string> &paths, vector<pair<int, string> > &errVector, const ShipPlan& ship,
+                      const JobsRunner &runJobs) {
     initPortsContainersFiles(dir, paths, errVector);
     map<string, int> portToFileNum;
+    vector<vector<pair<int, string>>> portsErrors(ports.size()); // Errors of each port, merged by the route order
+    vector<std::function<void()>> parseJobs; // Parsing of the containers file of each port
+    portsCargo.assign(ports.size(), nullptr);
     int portNumInRoute = -1;
     for(auto& port : ports){
         portNumInRoute++;
@@ -69,15 +78,21 @@ void Route::initPorts(const string &dir, vector<string> &paths, vector<pair<int,
                 string portNumS = (*it).substr(indexOfFirst_InPath + 1, (*it).find('.') - (indexOfFirst_InPath + 1));
                 int portNum = stoi(portNumS);
                 if (portNum == portToFileNum[port.getName()]) {
+                    string currentPortPath = dir + std::filesystem::path::preferred_separator + (*it);
+                    portsContainersPathsSorted.push_back(currentPortPath);
                     if (portNumInRoute == (int) ports.size() - 1) { // last port
-                        if(checkLastPortContainers(*it, true)){
-                            errVector.emplace_back(17,"Last port shouldn't has waiting containers");
+                        portsCargo[portNumInRoute] = std::make_shared<const CargoFile>(currentPortPath);
+                        if(!portsCargo[portNumInRoute]->lines.empty()){
+                            portsErrors[portNumInRoute].emplace_back(17,"Last port shouldn't has waiting containers");
                         }
-                        portsContainersPathsSorted.push_back(dir + std::filesystem::path::preferred_separator + (*it));
                     } else {
-                        string currentPortPath = dir + std::filesystem::path::preferred_separator + (*it);
-                        portsContainersPathsSorted.push_back(currentPortPath);
-                        ports[portNumInRoute].initWaitingContainers(currentPortPath, errVector, ship, getLeftPortsNames(portNumInRoute));
+                        parseJobs.emplace_back([this, portNumInRoute, currentPortPath, &portsErrors, &ship,
+                                                nextPorts = getLeftPortsNames(portNumInRoute)] {
+                            auto cargo = std::make_shared<const CargoFile>(currentPortPath);
+                            ports[portNumInRoute].initWaitingContainers(*cargo, portsErrors[portNumInRoute], ship,
+                                                                        nextPorts);
+                            portsCargo[portNumInRoute] = std::move(cargo);
+                        });
                     }
                     portsContainersPaths.erase(it);
                     findFile = true;
@@ -89,10 +104,19 @@ void Route::initPorts(const string &dir, vector<string> &paths, vector<pair<int,
             continue;
         portsContainersPathsSorted.push_back(empty_file);
         if(portNumInRoute != (int)ports.size() - 1){
-            errVector.emplace_back(-1,"No waiting containers in Port " + port.getName() +
+            portsErrors[portNumInRoute].emplace_back(-1,"No waiting containers in Port " + port.getName() +
                                       " for visit number: " + to_string(portToFileNum[port.getName()]));
         }
     }
+    // Each job fills only its own port and errors vector, so the files may be parsed in any order
+    if(runJobs) {
+        runJobs(parseJobs);
+    } else {
+        for(auto& job : parseJobs)
+            job();
+    }
+    for(auto& portErrors : portsErrors)
+        errVector.insert(errVector.end(), portErrors.begin(), portErrors.end());
 }
 
 void Route::initPortsContainersFiles(const string& dir, vector<string>& paths, vector<pair<int,string>>& errVector){
@@ -140,27 +164,17 @@ bool Route::moveToNextPortWithoutContInit() { // TODO: delete this function
         return false;
     currentPortNum++;
     portVisits[getCurrentPort().getName()]++;
+    getCurrentPort().materializeWaitingContainers();
     return true;
 }
 
-bool Route::checkLastPortContainers(const string& lastPortPath, bool addDir) {
-    string path = addDir ? dir + std::filesystem::path::preferred_separator : "";
-    path.append(lastPortPath);
-    FileHandler lastPortFile(path);
-    vector<string> tokens;
-    return lastPortFile.getNextLineAsTokens(tokens);
-}
-
 bool Route::moveToNextPort(const ShipPlan& ship) {
     if(!hasNextPort())
         return false;
     currentPortNum++;
     portVisits[getCurrentPort().getName()]++;
-    for(auto& cont : getCurrentPort().getWaitingContainers()){
-        if(ship.isContOnShip(cont.getID())){
-            cont.invalidateContainer();
-        }
-    }
+    getCurrentPort().materializeWaitingContainers();
+    getCurrentPort().invalidateContainersOnShip(ship);
     return true;
 }
 
@@ -174,6 +188,18 @@ string Route::getCloserDestination(const string &d1, const string &d2) {
     return "Not Found";
 }
 
+void Route::shareWaitingContainers() {
+    for(Port& p : ports)
+        p.shareWaitingContainers();
+}
+
+int Route::getNumOfWaitingContainers() const {
+    int num = 0;
+    for(const Port& p : ports)
+        num += p.getNumOfWaitingContainers();
+    return num;
+}
+
 bool Route::isInRoute(const string &portName) const {
     for(auto it = ports.begin() + currentPortNum; it != ports.end(); ++it)
         if(portName == (*it).getName())
@@ -181,14 +207,23 @@ bool Route::isInRoute(const string &portName) const {
     return false;
 }
 
+std::unordered_map<string, int> Route::getDestinationsRanks() const {
+    std::unordered_map<string, int> ranks;
+    for (int i = std::max(currentPortNum, 0); i < (int) ports.size(); i++)
+        ranks.emplace(ports[i].getName(), i - currentPortNum); // Kept if the port was already ranked by a closer visit
+    return ranks;
+}
+
+int Route::getDestinationRank(const std::unordered_map<string, int> &ranks, const string &dest) {
+    auto found = ranks.find(dest);
+    return found == ranks.end() ? NOT_IN_ROUTE_RANK : found->second;
+}
+
 void Route::sortContainersByDestination(vector<Container>& containers){
-    sort(containers.begin(), containers.end(),[this](Container& c1, Container& c2){
-        string dest1 = c1.getDestPort();
-        string dest2 = c2.getDestPort();
-        if(dest1 == dest2) // same destination, dont care about order for this case
-            return false;
-        string closeDest = this->getCloserDestination(dest1, dest2);
-        return dest1 == closeDest;
+    std::unordered_map<string, int> ranks = getDestinationsRanks(); // Once, instead of scanning the route per comparison
+    sort(containers.begin(), containers.end(),[&ranks](const Container& c1, const Container& c2){
+        // Containers with the same destination (or with destinations that aren't in the route) are equivalent
+        return getDestinationRank(ranks, c1.getDestPort()) < getDestinationRank(ranks, c2.getDestPort());
     });
 }
 
@@ -200,7 +235,7 @@ ostream& operator<<(ostream& os, const Route& r){
     return os;
 }
 
-vector<string> Route::getLeftPortsNames(int fromPortNum) {
+vector<string> Route::getLeftPortsNames(int fromPortNum) const {
     vector<string> names;
     if(fromPortNum == -1)
         fromPortNum = currentPortNum;
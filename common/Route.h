@@ -12,15 +12,24 @@
 #include <algorithm>
 #include <filesystem>
 #include <map>
+#include <functional>
+#include <climits>
+#include <unordered_map>
 
 #include "Port.h"
 #include "Utils.h"
 
 #define indexOfFirst_InPath (5)
+#define NOT_IN_ROUTE_RANK INT_MAX // The rank of a destination that isn't in the left route, after all of the others
 
 using std::map;
 using std::to_string;
 
+/**
+ * Runs all of the given jobs and returns once all of them are done, may run them in parallel.
+ */
+typedef std::function<void(vector<std::function<void()>> &jobs)> JobsRunner;
+
 //---Main class---//
 class Route {
 private:
@@ -29,6 +38,8 @@ private:
     string dir; // The directory of the files
     vector<string> portsContainersPaths; // Contain relative paths to the containers files, that have not used yet
     vector<string> portsContainersPathsSorted; // sorted vector of the containers files, base on the route (plus empty files where needed)
+    vector<std::shared_ptr<const CargoFile>> portsCargo; // The cargo file of each port by the route order (nullptr
+                                                         // if the port has none), shared between copies of the route
     map<string, int> portVisits; // How many times ports were visited
     string empty_file; // Path to an empty file for ports without containers
 
@@ -46,15 +57,24 @@ public:
 
     /**
      * Init the route from the given path file
+     * @param errs: the sink of the errors (a MessagesSink or a FlagsSink)
      */
-    void initRouteFromFile(const string &path, vector<pair<int,string>>& errVector, bool& fatalError);
+    template<typename ErrorSink>
+    void initRouteFromFile(const string &path, ErrorSink& errs, bool& success);
+
+    void initRouteFromFile(const string &path, vector<pair<int,string>>& errVector, bool& success) {
+        MessagesSink errs{errVector};
+        initRouteFromFile(path, errs, success);
+    }
 
     /**
       * Sort the given paths for containers files base on the asked sorting formula
       * Also load the containers in each port
       * dir is the base directory and paths are relative path in this directory
+      * If @param runJobs is given, the containers files are parsed through it (errors are kept in route order)
       */
-    void initPorts(const string &dir, vector<string> &paths, vector<pair<int,string>>& errVector, const ShipPlan& ship);
+    void initPorts(const string &dir, vector<string> &paths, vector<pair<int,string>>& errVector, const ShipPlan& ship,
+                   const JobsRunner &runJobs = nullptr);
 
     /**
      * Return if there is at least one more port in the route
@@ -63,13 +83,6 @@ public:
         return currentPortNum < (int) (ports.size()) - 1;
     }
 
-    /**
-     * Check if the last port has waiting containers
-     * @param errVector: the errors vector
-     * @return true if there are
-     */
-    bool checkLastPortContainers(const string& lastPortPath, bool addDir);
-
     /**
      * Return the true if there is at least one more port in the route
      */
@@ -85,14 +98,46 @@ public:
         return ports[currentPortNum];
     }
 
+    int getCurrentPortNum() const {
+        return currentPortNum;
+    }
+
     string& getCurrentPortPath(){
         return portsContainersPathsSorted[currentPortNum];
     }
 
+    const string& getPortPathAt(int portNum) const {
+        return portsContainersPathsSorted[portNum];
+    }
+
+    /**
+     * Return the cargo file that was read for the port with number @param portNum, nullptr if none was read
+     */
+    const CargoFile *getPortCargo(int portNum) const {
+        if (portNum < 0 || portNum >= (int) portsCargo.size())
+            return nullptr;
+        return portsCargo[portNum].get();
+    }
+
     int getNumOfVisitsInPort(string& portName){
         return portVisits[portName];
     }
 
+    int getNumOfPorts() const {
+        return (int) ports.size();
+    }
+
+    /**
+     * Share the waiting containers of all of the ports between the copies of this route,
+     * each copy gets its own containers of a port once it arrives to it
+     */
+    void shareWaitingContainers();
+
+    /**
+     * Return the total number of containers waiting in all of the ports in the route
+     */
+    int getNumOfWaitingContainers() const;
+
     /**
      * Get the closer destination in the route between the two given ones
      */
@@ -107,7 +152,18 @@ public:
      * Get the ports in the route from the port with number @param fromPortNum
      * Default value is -1, means get left ports from the current one
      */
-    vector<string> getLeftPortsNames(int fromPortNum = -1);
+    vector<string> getLeftPortsNames(int fromPortNum = -1) const;
+
+    /**
+     * Get the rank of each of the left ports by the order the ship arrives to them, the current port's rank is 0
+     * (a port that is visited a few times is ranked by its next visit)
+     */
+    std::unordered_map<string, int> getDestinationsRanks() const;
+
+    /**
+     * Get the rank of @param dest among the given ranks, NOT_IN_ROUTE_RANK if it isn't one of them
+     */
+    static int getDestinationRank(const std::unordered_map<string, int> &ranks, const string &dest);
 
     /**
      * Sort the given containers vector by their destination, from the closest one to the farthest one
@@ -1,23 +1,20 @@
 #include "ShipPlan.h"
 
-// Make sure the line is made of only 3 integers
-bool validateShipPlanLine(const vector<string> &line, string &err_msg) {
+// Make sure the line is made of only 3 integers, returns the error's message if it's not
+const char *validateShipPlanLine(const vector<string> &line) {
     int i;
     for (i = 0; i < (int) (line.size()); ++i) {
         if (i == 3) {
-            err_msg = "Invalid ship file line was detected- too many arguments in a line.";
-            return false;
+            return "Invalid ship file line was detected- too many arguments in a line.";
         }
         if (!isPositiveNumber(line[i])) {
-            err_msg = "Invalid ship file line was detected.";
-            return false;
+            return "Invalid ship file line was detected.";
         }
     }
     if (i != 3) {
-        err_msg = "Invalid file was line was detected- not enough arguments in a line.";
-        return false;
+        return "Invalid file was line was detected- not enough arguments in a line.";
     }
-    return true;
+    return nullptr;
 }
 
 void ShipPlan::updateSpot(int x, int y, int unavailable_floors) {
@@ -35,30 +32,31 @@ int ShipPlan::getUnavailableFloorsNum(int x, int y) {
     return counter;
 }
 
-void ShipPlan::initShipPlanFromFile(const string &file_path, vector<pair<int, string>> &errs_msg, bool &success) {
+template<typename ErrorSink>
+void ShipPlan::initShipPlanFromFile(const string &file_path, ErrorSink &errs, bool &success) {
     FileHandler file(file_path);
     vector<string> line;
     int x, y, unavailable_floors;
-    string err;
+    const char *err;
 
     if (file.isFailed()) {
-        errs_msg.emplace_back(3, "Failed opening the ship plan file that was given.");
+        errs.add(3, [] { return "Failed opening the ship plan file that was given."; });
         success = false; // should skip to the next travel
         return;
     }
     // Initialize ship dimensions
     if (!file.getNextLineAsTokens(line)) {
-        errs_msg.emplace_back(3, "Empty ship plan file was given.");
+        errs.add(3, [] { return "Empty ship plan file was given."; });
         success = false; // should skip to the next travel
         return;
     }
-    if (!validateShipPlanLine(line, err)) {
-        errs_msg.emplace_back(3, err);
+    if ((err = validateShipPlanLine(line)) != nullptr) {
+        errs.add(3, [err] { return err; });
         success = false; // should skip to the next travel
         return;
     }
     if (!validateShipSize(string2int(line[0]), string2int(line[1]), string2int(line[2]))) {
-        errs_msg.emplace_back(3, "Invalid ship plan file was given- exceeded ship limits.");
+        errs.add(3, [] { return "Invalid ship plan file was given- exceeded ship limits."; });
         success = false; // should skip to the next travel
         return;
     }
@@ -72,35 +70,39 @@ void ShipPlan::initShipPlanFromFile(const string &file_path, vector<pair<int, st
     }
     this->free_spots_num = this->rows * this->cols * this->num_of_decks;
     while (file.getNextLineAsTokens(line)) {
-        if (!validateShipPlanLine(line, err)) {
-            errs_msg.emplace_back(2, err);
+        if ((err = validateShipPlanLine(line)) != nullptr) {
+            errs.add(2, [err] { return err; });
             continue;
         }
         x = string2int(line[0]);
         y = string2int(line[1]);
         if (!spotInRange(x, y)) {
-            errs_msg.emplace_back(1,
-                                  "A spot that exceeds the X/Y ship limits was detected while initializing the ship plan: x = " +
-                                  line[0] + "; y = " + line[1] + ";");
+            errs.add(1, [&line] {
+                return "A spot that exceeds the X/Y ship limits was detected while initializing the ship plan: x = " +
+                       line[0] + "; y = " + line[1] + ";";
+            });
             continue;
         }
         unavailable_floors = this->num_of_decks - string2int(line[2]);
         if (unavailable_floors <= 0) {
-            errs_msg.emplace_back(0,
-                                  "A spot which is available within the maximum number of floors or more was detected while initializing the ship plan: Available floors given is " +
-                                  line[2]);
+            errs.add(0, [&line] {
+                return "A spot which is available within the maximum number of floors or more was detected while initializing the ship plan: Available floors given is " +
+                       line[2];
+            });
             continue;
         } else { //unavailable_floors > 0
             if (!(this->decks[0].getFloorMap()[x][y].getAvailable())) { // In case the same spot was already initialized
                 if (getUnavailableFloorsNum(x, y) == unavailable_floors) {
-                    errs_msg.emplace_back(2,
-                                          "A spot which was already initialized with the same number of available floors was detected while initializing the ship plan: Spot indexes are x = " +
-                                          line[0] + "; y = " + line[1] + ";");
+                    errs.add(2, [&line] {
+                        return "A spot which was already initialized with the same number of available floors was detected while initializing the ship plan: Spot indexes are x = " +
+                               line[0] + "; y = " + line[1] + ";";
+                    });
                     continue;
                 } else {
-                    errs_msg.emplace_back(2,
-                                          "A spot which was already initialized with a different number of available floors was detected while initializing the ship plan: Spot indexes are x = " +
-                                          line[0] + "; y = " + line[1] + ";");
+                    errs.add(2, [&line] {
+                        return "A spot which was already initialized with a different number of available floors was detected while initializing the ship plan: Spot indexes are x = " +
+                               line[0] + "; y = " + line[1] + ";";
+                    });
                     success = false; // should skip to the next travel
                     return;
                 }
@@ -110,6 +112,10 @@ void ShipPlan::initShipPlanFromFile(const string &file_path, vector<pair<int, st
     }
 }
 
+template void ShipPlan::initShipPlanFromFile<MessagesSink>(const string &, MessagesSink &, bool &);
+
+template void ShipPlan::initShipPlanFromFile<FlagsSink>(const string &, FlagsSink &, bool &);
+
 ostream &operator<<(ostream &out, const ShipPlan &s) {
     out << "The ship size is: " << s.rows << "," << s.cols
         << "," << s.num_of_decks << "(Rows,Colums,Height)" << endl;
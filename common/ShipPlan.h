@@ -3,6 +3,7 @@
 
 #include "Floor.h"
 #include "Utils.h"
+#include "ErrorSinks.h"
 #include <cstdlib>
 #include <iostream>
 #include <vector>
@@ -67,7 +68,16 @@ public:
 
     //---Class Functions---//
 
-    void initShipPlanFromFile(const string& file_path, vector<pair<int,string>> &err_msg, bool &success);
+    /**
+     * Initializes the ship from the given file, its errors are reported to @param errs (a MessagesSink or a FlagsSink).
+     */
+    template<typename ErrorSink>
+    void initShipPlanFromFile(const string& file_path, ErrorSink &errs, bool &success);
+
+    void initShipPlanFromFile(const string& file_path, vector<pair<int,string>> &err_msg, bool &success) {
+        MessagesSink errs{err_msg};
+        initShipPlanFromFile(file_path, errs, success);
+    }
 
     friend ostream &operator<<(ostream &out, const ShipPlan &s);
 
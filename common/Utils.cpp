@@ -1,5 +1,7 @@
 #include "Utils.h"
 
+#define LINE_WHITESPACES " \t\v\f\r" // Trimmed around the lines and the tokens of the files
+
 int string2int(const string &s) {
     return (std::stoi(s));
 }
@@ -11,7 +13,7 @@ bool isNumber(const string &s) {
     return (*p == 0);
 }
 
-string trimWhitespaces(const string &str, const string &whitespace = " \t\v\f\r") {
+string trimWhitespaces(const string &str, const string &whitespace = LINE_WHITESPACES) {
     const auto strBegin = str.find_first_not_of(whitespace);
     if (strBegin == string::npos)
         return ""; // no content
@@ -137,7 +139,9 @@ FileHandler::FileHandler(const string &path, bool truncFlag) : fs(), path(path)
 
 bool FileHandler::getNextLine(string &line) {
     while (getline(this->fs, line)) {
-        line = trimWhitespaces(line);
+        // Trimmed in place, so the line's buffer is kept for the next lines
+        line.erase(line.find_last_not_of(LINE_WHITESPACES) + 1);
+        line.erase(0, line.find_first_not_of(LINE_WHITESPACES));
         if (line[0] == '#' || line.empty())
             continue;
         return true;
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <vector>
 #include <filesystem>
+#include "../interfaces/AlgorithmExtensions.h"
 
 
 using std::cout;
@@ -109,4 +110,19 @@ public:
 
 };
 
+/**
+ * Writes the instructions it's given to an instructions file
+ */
+class InstructionsFile : public InstructionsSink {
+private:
+    FileHandler file;
+public:
+    explicit InstructionsFile(const string &path) : file(path, true) {}
+
+    void addInstruction(AbstractAlgorithm::Action action, const string &container_id, int floor, int x, int y,
+                        int dest_floor, int dest_x, int dest_y) override {
+        file.writeInstruction(string(1, (char) action), container_id, floor, x, y, dest_floor, dest_x, dest_y);
+    }
+};
+
 #endif //STOWAGEPROJECT_UTILS_H
@@ -0,0 +1,78 @@
+// AlgorithmExtensions.h
+
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include "AbstractAlgorithm.h"
+
+// Optional extensions of AbstractAlgorithm. The simulator learns which ones an algorithm implements when it registers,
+// so algorithms that were built before an extension existed keep working without it.
+enum AlgorithmExtension : unsigned int {
+    NO_EXTENSIONS = 0,
+    INSTRUCTIONS_CHANNEL = 1, // The algorithm is an InstructionsChannelAlgorithm
+    PARSED_INPUT_V1 = 2 // The algorithm is a ParsedInputAlgorithm, built with version 1 of ParsedInput
+};
+
+// The version of ParsedInput in this header. The views it gives are classes of common/, shared by the simulator and
+// the algorithm as they are, so any change of their layout takes the flag of a new version. An algorithm of another
+// version is given the files' paths only.
+#define PARSED_INPUT_VERSION PARSED_INPUT_V1
+
+class ShipPlan;
+class Route;
+struct CargoFile;
+
+// Receives the crane instructions of a port, by their order
+class InstructionsSink {
+public:
+    virtual ~InstructionsSink(){}
+
+// the destination is given for a MOVE only
+    virtual void addInstruction(AbstractAlgorithm::Action action, const std::string& container_id, int floor, int x,
+                                int y, int dest_floor = -1, int dest_x = -1, int dest_y = -1) = 0;
+};
+
+// An algorithm that hands the instructions of a port to the simulator in memory, instead of writing them to a file
+// that the simulator reads back
+class InstructionsChannelAlgorithm : public AbstractAlgorithm {
+public:
+// same as getInstructionsForCargo, the instructions go to the given sink instead of the output file
+    virtual int sendInstructionsForCargo(
+            const std::string& input_full_path_and_file_name,
+            InstructionsSink& instructions) = 0;
+};
+
+// Read only views of a travel's input, as the simulator parsed and validated it. The views are valid until the
+// algorithm is destroyed. The simulator runs only travels that have a valid ship plan and route.
+class ParsedInput {
+public:
+    virtual ~ParsedInput(){}
+
+// the ship plan as readShipPlan reads it from its file, and the error codes of the file
+    virtual const ShipPlan& getShipPlan() const = 0;
+    virtual int getShipPlanErrors() const = 0;
+
+// the route as readShipRoute reads it from its file (its ports have no containers), and the error codes of the file
+    virtual const Route& getRoute() const = 0;
+    virtual int getRouteErrors() const = 0;
+
+// the cargo file of the port with the given number in the route (counted from 0), nullptr if it wasn't read
+    virtual const CargoFile* getPortCargo(int port_num) const = 0;
+};
+
+// An instructions channel algorithm that also takes the travel's input as the simulator parsed it, instead of parsing
+// its files again.
+// The simulator still calls readShipPlan, readShipRoute and getInstructionsForCargo with the files' paths, the
+// algorithm reads a file only if its parsed view is missing.
+class ParsedInputAlgorithm : public InstructionsChannelAlgorithm {
+public:
+// called before readShipPlan
+    virtual int setParsedInput(const ParsedInput& input) = 0;
+};
+
+template<typename Algorithm>
+constexpr unsigned int getAlgorithmExtensions() {
+    return (std::is_base_of_v<InstructionsChannelAlgorithm, Algorithm> ? INSTRUCTIONS_CHANNEL : NO_EXTENSIONS) |
+           (std::is_base_of_v<ParsedInputAlgorithm, Algorithm> ? PARSED_INPUT_VERSION : NO_EXTENSIONS);
+}
@@ -5,12 +5,15 @@
 #include <functional>
 #include <memory>
 #include "AbstractAlgorithm.h"
+#include "AlgorithmExtensions.h"
 
 class AlgorithmRegistration {
 public:
     AlgorithmRegistration(std::function<std::unique_ptr<AbstractAlgorithm>()>);
+    // registers an algorithm with the extensions it implements, see AlgorithmExtensions.h
+    AlgorithmRegistration(std::function<std::unique_ptr<AbstractAlgorithm>()>, unsigned int extensions);
 };
 
 #define REGISTER_ALGORITHM(class_name) \
 AlgorithmRegistration register_me_##class_name \
-	([]{return std::make_unique<class_name>();} );
+	([]{return std::make_unique<class_name>();}, getAlgorithmExtensions<class_name>());
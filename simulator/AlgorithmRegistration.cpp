@@ -6,5 +6,10 @@
 #include "../interfaces/AlgorithmRegistration.h"
 
 AlgorithmRegistration::AlgorithmRegistration(std::function<std::unique_ptr<AbstractAlgorithm>()> algo_func){
-    Simulator::getInstance().registerAlgorithm(algo_func);
-}
\ No newline at end of file
+    Simulator::getInstance().registerAlgorithm(algo_func); // Built before the extensions, so it has none
+}
+
+AlgorithmRegistration::AlgorithmRegistration(std::function<std::unique_ptr<AbstractAlgorithm>()> algo_func,
+                                             unsigned int extensions){
+    Simulator::getInstance().registerAlgorithm(algo_func, extensions);
+}
@@ -0,0 +1,45 @@
+/**
+ * A blocking queue with a fixed capacity, used to pass items between two pipeline stages.
+ * push() waits while the queue is full and pop() waits while it is empty. The capacity applies only once pop() was
+ * called, so a producer that runs before its consumer (on the same thread, if no other one is free) isn't blocked.
+ */
+
+#ifndef SHIPPROJECT_BOUNDEDQUEUE_H
+#define SHIPPROJECT_BOUNDEDQUEUE_H
+
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+template<typename T>
+class BoundedQueue {
+private:
+    std::queue<T> items;
+    size_t capacity;
+    std::mutex itemsMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool consumerStarted = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity < 1 ? 1 : capacity) {}
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(itemsMutex);
+        notFull.wait(lock, [this] { return !consumerStarted || items.size() < capacity; });
+        items.push(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(itemsMutex);
+        consumerStarted = true;
+        notEmpty.wait(lock, [this] { return !items.empty(); });
+        T item = std::move(items.front());
+        items.pop();
+        notFull.notify_one();
+        return item;
+    }
+};
+
+#endif //SHIPPROJECT_BOUNDEDQUEUE_H
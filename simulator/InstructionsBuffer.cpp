@@ -0,0 +1,176 @@
+#include "InstructionsBuffer.h"
+#include "../common/Utils.h"
+#include <charconv>
+
+#define MAX_INSTRUCTION_FIELDS 8 // The fields of a move instruction, the other instructions have 5
+#define INSTRUCTION_WHITESPACES " \t\v\f\r" // Trimmed around each field, as FileHandler trims the tokens
+
+/**
+ * Returns the given field without the whitespaces around it.
+ */
+std::string_view trimInstructionField(std::string_view field) {
+    size_t begin = field.find_first_not_of(INSTRUCTION_WHITESPACES);
+    if (begin == std::string_view::npos)
+        return {};
+    return field.substr(begin, field.find_last_not_of(INSTRUCTION_WHITESPACES) - begin + 1);
+}
+
+/**
+ * Decodes an integer field, which may have a sign as isNumber() accepts. Returns false if it isn't an integer (or it
+ * doesn't fit in an int).
+ */
+bool parseInstructionInt(std::string_view field, int &value) {
+    if (!field.empty() && field[0] == '+') {
+        field.remove_prefix(1);
+        if (!field.empty() && field[0] == '-')
+            return false; // A second sign
+    }
+    const char *end = field.data() + field.size();
+    auto [parsed_end, err] = std::from_chars(field.data(), end, value);
+    return !field.empty() && err == std::errc() && parsed_end == end;
+}
+
+bool CraneInstruction::parse(std::string_view line, CraneInstruction &instruction) {
+    std::string_view fields[MAX_INSTRUCTION_FIELDS];
+    int num_of_fields = 0;
+    for (size_t comma = 0; comma != std::string_view::npos; line.remove_prefix(comma + 1)) {
+        if (num_of_fields == MAX_INSTRUCTION_FIELDS)
+            return false; // Wrong number of arguments for any instruction
+        comma = line.find(',');
+        fields[num_of_fields++] = trimInstructionField(line.substr(0, comma));
+        if (comma == std::string_view::npos)
+            break;
+    }
+    if (num_of_fields == 5 && fields[0] == "L") {
+        instruction.action = AbstractAlgorithm::Action::LOAD;
+    } else if (num_of_fields == 5 && fields[0] == "U") {
+        instruction.action = AbstractAlgorithm::Action::UNLOAD;
+    } else if (num_of_fields == 5 && fields[0] == "R") {
+        instruction.action = AbstractAlgorithm::Action::REJECT;
+    } else if (num_of_fields == 8 && fields[0] == "M") {
+        instruction.action = AbstractAlgorithm::Action::MOVE;
+    } else {
+        return false; // Invalid instruction, or a wrong number of arguments for it
+    }
+    instruction.container_id = fields[1]; // Validated later
+    if (!parseInstructionInt(fields[2], instruction.floor) || !parseInstructionInt(fields[3], instruction.x) ||
+        !parseInstructionInt(fields[4], instruction.y))
+        return false;
+    if (instruction.action != AbstractAlgorithm::Action::MOVE) {
+        instruction.dest_floor = instruction.dest_x = instruction.dest_y = -1;
+        return true;
+    }
+    return parseInstructionInt(fields[5], instruction.dest_floor) && parseInstructionInt(fields[6], instruction.dest_x) &&
+           parseInstructionInt(fields[7], instruction.dest_y);
+}
+
+/**
+ * Appends the instruction's line, as FileHandler::writeInstruction() writes it.
+ */
+void appendInstructionLine(string &text, AbstractAlgorithm::Action action, const string &container_id, int floor,
+                           int x, int y, int dest_floor, int dest_x, int dest_y) {
+    char number[16];
+    auto appendNumber = [&text, &number](int value) {
+        text += ',';
+        text.append(number, std::to_chars(number, number + sizeof(number), value).ptr);
+    };
+    text += (char) action;
+    text += ',';
+    text += container_id;
+    appendNumber(floor);
+    appendNumber(x);
+    appendNumber(y);
+    if (action == AbstractAlgorithm::Action::MOVE) {
+        appendNumber(dest_floor);
+        appendNumber(dest_x);
+        appendNumber(dest_y);
+    }
+    text += '\n';
+}
+
+/**
+ * Returns true if the container ID would be read back from an instructions file as it is: a single field, with no
+ * whitespaces around it.
+ */
+bool isPlainContainerId(const string &container_id) {
+    if (container_id.find_first_of(",\n") != string::npos)
+        return false;
+    return container_id.empty() || (container_id.find_first_of(INSTRUCTION_WHITESPACES) != 0 &&
+                                    container_id.find_last_of(INSTRUCTION_WHITESPACES) != container_id.size() - 1);
+}
+
+void InstructionsBuffer::addLine(std::string_view line) {
+    Entry entry;
+    entry.legal = CraneInstruction::parse(line, entry.instruction);
+    if (entry.legal) {
+        entry.idBegin = ids.size();
+        entry.idSize = entry.instruction.container_id.size();
+        ids += entry.instruction.container_id;
+        entry.instruction.container_id = {};
+    }
+    entries.push_back(entry);
+}
+
+void InstructionsBuffer::addLines(std::string_view lines) {
+    for (size_t end = lines.find('\n'); end != std::string_view::npos; end = lines.find('\n')) {
+        std::string_view line = lines.substr(0, end);
+        lines.remove_prefix(end + 1);
+        size_t begin = line.find_first_not_of(INSTRUCTION_WHITESPACES);
+        if (begin == std::string_view::npos || line[begin] == '#')
+            continue; // Skipped by FileHandler::getNextLine()
+        addLine(line.substr(begin, line.find_last_not_of(INSTRUCTION_WHITESPACES) - begin + 1));
+    }
+}
+
+void InstructionsBuffer::addInstruction(AbstractAlgorithm::Action action, const string &container_id, int floor,
+                                        int x, int y, int dest_floor, int dest_x, int dest_y) {
+    if (keepText)
+        appendInstructionLine(text, action, container_id, floor, x, y, dest_floor, dest_x, dest_y);
+    if (!isPlainContainerId(container_id) ||
+        (action != AbstractAlgorithm::Action::LOAD && action != AbstractAlgorithm::Action::UNLOAD &&
+         action != AbstractAlgorithm::Action::MOVE && action != AbstractAlgorithm::Action::REJECT)) {
+        // Decoded from its line (or lines) as it would be read from the file, so it's validated the same
+        string line;
+        appendInstructionLine(line, action, container_id, floor, x, y, dest_floor, dest_x, dest_y);
+        addLines(line);
+        return;
+    }
+    Entry entry;
+    entry.instruction.action = action;
+    entry.instruction.floor = floor;
+    entry.instruction.x = x;
+    entry.instruction.y = y;
+    bool move = action == AbstractAlgorithm::Action::MOVE;
+    entry.instruction.dest_floor = move ? dest_floor : -1;
+    entry.instruction.dest_x = move ? dest_x : -1;
+    entry.instruction.dest_y = move ? dest_y : -1;
+    entry.idBegin = ids.size();
+    entry.idSize = container_id.size();
+    entry.legal = true;
+    ids += container_id;
+    entries.push_back(entry);
+}
+
+void InstructionsBuffer::readFile(const string &path) {
+    FileHandler file(path);
+    string line;
+    while (file.getNextLine(line)) {
+        addLine(line);
+    }
+}
+
+bool InstructionsBuffer::writeFile(const string &path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    file.write(text.data(), (std::streamsize) text.size());
+    file.close();
+    return !file.fail();
+}
+
+bool InstructionsBuffer::getInstruction(int index, CraneInstruction &instruction) const {
+    const Entry &entry = entries[index];
+    if (!entry.legal)
+        return false;
+    instruction = entry.instruction;
+    instruction.container_id = std::string_view(ids).substr(entry.idBegin, entry.idSize);
+    return true;
+}
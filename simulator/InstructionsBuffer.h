@@ -0,0 +1,90 @@
+/**
+ * The crane instructions of a port, kept in memory by their order. An algorithm with the instructions channel adds
+ * them right to the buffer, the instructions file of any other algorithm is read into it. An instruction is decoded as
+ * it would be from its line in the file either way, so the simulation validates both the same.
+ */
+
+#ifndef SHIPPROJECT_INSTRUCTIONSBUFFER_H
+#define SHIPPROJECT_INSTRUCTIONSBUFFER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../interfaces/AlgorithmExtensions.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * A line of a crane instructions file, decoded once into its action, its container and its positions.
+ * The container's ID views the line it was decoded from, so the record is valid only while the line is kept.
+ */
+struct CraneInstruction {
+    AbstractAlgorithm::Action action;
+    std::string_view container_id;
+    int floor, x, y; // The position of the container, the source one of a move
+    int dest_floor, dest_x, dest_y; // The destination of a move, -1 for the other actions
+
+    /**
+     * Decodes the given (trimmed) line. Returns false if it isn't a legal instruction: an unknown action, a wrong
+     * number of fields for the action or a position that isn't an integer.
+     */
+    static bool parse(std::string_view line, CraneInstruction &instruction);
+};
+
+class InstructionsBuffer : public InstructionsSink {
+private:
+    struct Entry {
+        CraneInstruction instruction{}; // Its container ID is set when it's taken, the IDs may move until then
+        size_t idBegin = 0; // The container ID in ids
+        size_t idSize = 0;
+        bool legal = false; // False if the line isn't a legal instruction
+    };
+
+    vector<Entry> entries;
+    string ids; // The containers IDs of the instructions, one after the other
+    bool keepText = false;
+    string text; // The instructions as an instructions file has them, if they are kept
+
+    /**
+     * Decodes the given line of an instructions file, which is trimmed as FileHandler::getNextLine() trims it.
+     */
+    void addLine(std::string_view line);
+
+    /**
+     * Decodes the lines of the given text (each ends with a new line) as FileHandler::getNextLine() reads them.
+     */
+    void addLines(std::string_view lines);
+
+public:
+    /**
+     * @param keepText: keep the instructions as an instructions file has them, so they can be written to one
+     */
+    explicit InstructionsBuffer(bool keepText = false) : keepText(keepText) {}
+
+    void addInstruction(AbstractAlgorithm::Action action, const string &container_id, int floor, int x, int y,
+                        int dest_floor, int dest_x, int dest_y) override;
+
+    /**
+     * Adds the instructions of the given file (they aren't kept as text, the file already has them), nothing is added
+     * if it can't be read.
+     */
+    void readFile(const string &path);
+
+    /**
+     * Writes the kept instructions to the given file, returns false if it can't be written.
+     */
+    bool writeFile(const string &path) const;
+
+    int size() const {
+        return (int) entries.size();
+    }
+
+    /**
+     * Sets @param instruction to the instruction with the given index. Returns false if its line isn't a legal
+     * instruction, the instruction isn't set in that case.
+     */
+    bool getInstruction(int index, CraneInstruction &instruction) const;
+};
+
+#endif //SHIPPROJECT_INSTRUCTIONSBUFFER_H
@@ -0,0 +1,109 @@
+#include "../common/Logger.h"
+#include <iostream>
+#include <chrono>
+
+#define DRAIN_INTERVAL std::chrono::milliseconds(10) // The background thread checks the rings at least this often
+
+thread_local Logger::Ring *Logger::threadRing = nullptr;
+
+Logger &Logger::getInstance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger::Ring &Logger::getThreadRing() {
+    if (threadRing == nullptr) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<Ring>());
+        threadRing = rings.back().get();
+    }
+    return *threadRing;
+}
+
+void Logger::printNow(const std::string &message) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << message << std::endl;
+}
+
+void Logger::log(LogLevel messageLevel, const std::string &message) {
+    if (!isEnabled(messageLevel))
+        return;
+    if (!running.load(std::memory_order_acquire)) {
+        printNow(message);
+        return;
+    }
+    Ring &ring = getThreadRing();
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    while (tail - ring.head.load(std::memory_order_acquire) == LOG_RING_SIZE) { // Full, wait for the drain
+        if (!running.load(std::memory_order_acquire)) {
+            printNow(message);
+            return;
+        }
+        drainCond.notify_one();
+        std::this_thread::yield();
+    }
+    ring.messages[tail % LOG_RING_SIZE].assign(message);
+    // Sequentially consistent with stop(), so either the message is published before its final drain, or the
+    // logger is seen stopped here and the message is drained by this thread
+    ring.tail.store(tail + 1, std::memory_order_seq_cst);
+    if (!running.load(std::memory_order_seq_cst))
+        drain();
+}
+
+bool Logger::drain() {
+    std::string output;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (auto &ring : rings) {
+            size_t head = ring->head.load(std::memory_order_relaxed);
+            size_t tail = ring->tail.load(std::memory_order_seq_cst);
+            for (; head != tail; ++head) {
+                output += ring->messages[head % LOG_RING_SIZE];
+                output += '\n';
+            }
+            ring->head.store(tail, std::memory_order_release);
+        }
+    }
+    if (output.empty())
+        return false;
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << output;
+    std::cout.flush(); // Once for all of the drained messages
+    return true;
+}
+
+void Logger::drainerFunc() {
+    std::unique_lock<std::mutex> lock(drainMutex);
+    while (!stopping) {
+        drainCond.wait_for(lock, DRAIN_INTERVAL);
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void Logger::start() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    if (drainer.joinable())
+        return;
+    stopping = false;
+    drainer = std::thread(&Logger::drainerFunc, this);
+    running.store(true, std::memory_order_release);
+}
+
+void Logger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        if (!drainer.joinable())
+            return;
+        running.store(false, std::memory_order_seq_cst); // Messages from now on are printed right away
+        stopping = true;
+    }
+    drainCond.notify_one();
+    drainer.join();
+    drain(); // What was logged while the background thread was stopping
+}
@@ -0,0 +1,162 @@
+#include "ProcessPool.h"
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#include <new>
+#include <csignal>
+#include <chrono>
+#include <thread>
+
+#define WATCH_INTERVAL std::chrono::milliseconds(10)
+
+ProcessPool::ProcessPool(int numOfWorkers, int numOfTasks, size_t slotSize)
+        : numOfWorkers(numOfWorkers < 1 ? 1 : numOfWorkers), numOfTasks(numOfTasks), slotSize(slotSize) {
+    size_t headerSize = sizeof(SharedState) + sizeof(std::atomic_llong) * this->numOfWorkers +
+                        sizeof(std::atomic_int) * this->numOfWorkers + sizeof(std::atomic_bool) * numOfTasks;
+    auto pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    slotsOffset = (headerSize + pageSize - 1) / pageSize * pageSize;
+    mappedSize = slotsOffset + slotSize * numOfTasks;
+    // Pages are given only once they are touched, so big slots that are hardly used cost nothing
+    void *area = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (area == MAP_FAILED)
+        return;
+    mapped = static_cast<char *>(area);
+    state = new(mapped) SharedState();
+    startTimes = reinterpret_cast<std::atomic_llong *>(mapped + sizeof(SharedState));
+    runningTasks = reinterpret_cast<std::atomic_int *>(startTimes + this->numOfWorkers);
+    doneTasks = reinterpret_cast<std::atomic_bool *>(runningTasks + this->numOfWorkers);
+    for (int i = 0; i < this->numOfWorkers; i++) {
+        new(&startTimes[i]) std::atomic_llong(0);
+        new(&runningTasks[i]) std::atomic_int(-1);
+    }
+    for (int i = 0; i < numOfTasks; i++) {
+        new(&doneTasks[i]) std::atomic_bool(false);
+    }
+}
+
+ProcessPool::~ProcessPool() {
+    if (mapped != nullptr)
+        munmap(mapped, mappedSize);
+}
+
+const char *ProcessPool::getSlot(int task) const {
+    return mapped + slotsOffset + slotSize * task;
+}
+
+void ProcessPool::releaseSlot(int task) {
+    // Only the pages that are entirely in the slot, the ones it shares with its neighbours stay
+    auto pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t start = (slotsOffset + slotSize * task + pageSize - 1) / pageSize * pageSize;
+    size_t end = (slotsOffset + slotSize * (task + 1)) / pageSize * pageSize;
+    if (start < end)
+        madvise(mapped + start, end - start, MADV_REMOVE);
+}
+
+void ProcessPool::workerFunc(int id, const TaskFunc &runTask) {
+    int task;
+    while ((task = state->nextTask++) < numOfTasks) {
+        // The steady clock is shared by all of the processes, so the parent can tell how long the task runs
+        startTimes[id] = std::chrono::steady_clock::now().time_since_epoch().count();
+        runningTasks[id] = task;
+        runTask(task, const_cast<char *>(getSlot(task)), slotSize);
+        doneTasks[task].store(true, std::memory_order_release);
+        runningTasks[id] = -1;
+    }
+}
+
+bool ProcessPool::spawnWorker(int id, const TaskFunc &runTask) {
+    std::cout.flush(); // Otherwise the buffered output is printed by both of the processes
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        workerFunc(id, runTask);
+        std::cout.flush();
+        _exit(EXIT_SUCCESS); // Don't run the parent's exit handlers and destructors
+    }
+    workers[pid] = id;
+    return true;
+}
+
+void ProcessPool::killTimedOutWorkers(const BudgetFunc &taskBudget, map<pid_t, bool> &timedOut) {
+    long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+    for (auto &worker : workers) {
+        int task = runningTasks[worker.second];
+        if (task < 0 || timedOut[worker.first])
+            continue;
+        int budget = taskBudget(task);
+        auto budgetTicks = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::seconds(budget)).count();
+        if (budget > 0 && now - startTimes[worker.second] > budgetTicks) {
+            kill(worker.first, SIGKILL); // The task may be stuck in an algorithm, it can't be stopped in any other way
+            timedOut[worker.first] = true;
+        }
+    }
+}
+
+void ProcessPool::reportDoneTasks(const DoneFunc &onTaskDone, vector<bool> &reported) {
+    for (int task = 0; task < numOfTasks; task++) {
+        if (!reported[task] && doneTasks[task].load(std::memory_order_acquire)) {
+            reported[task] = true;
+            onTaskDone(task);
+            releaseSlot(task);
+        }
+    }
+}
+
+vector<ProcessPool::FailedTask> ProcessPool::run(const TaskFunc &runTask, const BudgetFunc &taskBudget,
+                                                 const DoneFunc &onTaskDone) {
+    vector<FailedTask> failedTasks;
+    map<pid_t, bool> timedOut; // Workers that were killed by killTimedOutWorkers
+    vector<bool> reported(numOfTasks, false); // Tasks that onTaskDone was called for
+    for (int i = 0; i < numOfWorkers && i < numOfTasks; i++) {
+        spawnWorker(i, runTask);
+    }
+    if (workers.empty()) { // Couldn't fork at all, run the tasks in this process
+        workerFunc(0, runTask);
+        if (onTaskDone)
+            reportDoneTasks(onTaskDone, reported);
+        return failedTasks;
+    }
+    while (!workers.empty()) {
+        int status;
+        pid_t pid;
+        if (taskBudget || onTaskDone) { // Check the running tasks every WATCH_INTERVAL until a worker is done
+            while ((pid = waitpid(-1, &status, WNOHANG)) == 0) {
+                if (taskBudget)
+                    killTimedOutWorkers(taskBudget, timedOut);
+                if (onTaskDone)
+                    reportDoneTasks(onTaskDone, reported);
+                std::this_thread::sleep_for(WATCH_INTERVAL);
+            }
+        } else {
+            pid = wait(&status);
+        }
+        if (pid < 0)
+            break;
+        auto worker = workers.find(pid);
+        if (worker == workers.end())
+            continue;
+        int id = worker->second;
+        workers.erase(worker);
+        int task = runningTasks[id].exchange(-1);
+        if (task < 0)
+            continue; // The worker is done with all of its tasks
+        if (!doneTasks[task].load(std::memory_order_acquire)) // Otherwise it died right after the task was done
+            failedTasks.push_back(FailedTask{task, status, timedOut[pid]});
+        if (state->nextTask < numOfTasks && !spawnWorker(id, runTask) && workers.empty())
+            workerFunc(id, runTask); // No worker is left and a new one can't be forked
+    }
+    if (onTaskDone)
+        reportDoneTasks(onTaskDone, reported); // The tasks that were done after the last check
+    return failedTasks;
+}
+
+std::string ProcessPool::describeStatus(int status) {
+    if (WIFSIGNALED(status))
+        return "killed by signal " + std::to_string(WTERMSIG(status)) + " (" + strsignal(WTERMSIG(status)) + ")";
+    if (WIFEXITED(status))
+        return "exited with code " + std::to_string(WEXITSTATUS(status));
+    return "stopped unexpectedly";
+}
@@ -0,0 +1,127 @@
+/**
+ * The process pool class, runs tasks in forked worker processes instead of threads.
+ * Each task owns a slot in a shared memory area that is allocated before the workers are forked, the task writes its
+ * output there and the parent reads it once all of the tasks are done, or as soon as the task is done if it's told.
+ * In that case the slot's memory is given back right after the parent read it, so it doesn't grow with the tasks.
+ * A worker that dies while running a task costs only that task: the parent reports it and forks a new worker that
+ * goes on with the tasks that were not taken yet. A task may have a time budget, its worker is killed once it's over.
+ * Must be used before any other thread was started, forking a multithreaded process is not safe.
+ */
+
+#ifndef SHIPPROJECT_PROCESSPOOL_H
+#define SHIPPROJECT_PROCESSPOOL_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <cstddef>
+#include <sys/types.h>
+
+using std::vector;
+using std::map;
+using std::pair;
+
+class ProcessPool {
+public:
+    /**
+     * Runs the task with the given number, writing its output to the given slot of @param slotSize bytes.
+     */
+    typedef std::function<void(int task, char *slot, size_t slotSize)> TaskFunc;
+
+    /**
+     * Returns the seconds the task with the given number may run, 0 if it's not limited.
+     */
+    typedef std::function<int(int task)> BudgetFunc;
+
+    /**
+     * Called in the parent once the task with the given number is done, its slot holds its whole output until the
+     * call returns, then it's released.
+     */
+    typedef std::function<void(int task)> DoneFunc;
+
+    // A task that its worker died while running it
+    struct FailedTask {
+        int task;
+        int status; // The worker's wait status
+        bool timedOut; // The worker was killed since the task ran out of its time budget
+    };
+
+private:
+    // The beginning of the shared memory area
+    struct SharedState {
+        std::atomic_int nextTask{0}; // The next task that wasn't taken by any worker
+    };
+
+    int numOfWorkers;
+    int numOfTasks;
+    size_t slotSize;
+    size_t slotsOffset = 0; // The slots start at a page, so the pages of each slot can be released
+    size_t mappedSize = 0;
+    char *mapped = nullptr; // SharedState, the start times, the running tasks, the done flags, then the slots
+    SharedState *state = nullptr;
+    std::atomic_int *runningTasks = nullptr; // The task each worker runs right now, -1 if there is none
+    std::atomic_llong *startTimes = nullptr; // When each worker started its running task, in steady clock ticks
+    std::atomic_bool *doneTasks = nullptr; // Set by the worker once it wrote the task's whole output to its slot
+    map<pid_t, int> workers; // Worker's process id -> worker's number
+
+    /**
+     * Forks a worker process with the number @param id, returns false if fork failed.
+     */
+    bool spawnWorker(int id, const TaskFunc &runTask);
+
+    /**
+     * The worker process function, runs tasks until there are no more tasks to take.
+     */
+    void workerFunc(int id, const TaskFunc &runTask);
+
+    /**
+     * Kills the workers that their running task is over its time budget, and records them in @param timedOut.
+     */
+    void killTimedOutWorkers(const BudgetFunc &taskBudget, map<pid_t, bool> &timedOut);
+
+    /**
+     * Gives the memory of the task's slot back to the system, it reads as zeros from now on.
+     */
+    void releaseSlot(int task);
+
+    /**
+     * Calls @param onTaskDone for the tasks that are done and were not reported yet, and records them in @param reported.
+     * The slot of each reported task is released.
+     */
+    void reportDoneTasks(const DoneFunc &onTaskDone, vector<bool> &reported);
+
+public:
+    ProcessPool(int numOfWorkers, int numOfTasks, size_t slotSize);
+
+    ProcessPool(const ProcessPool &other) = delete;
+
+    ProcessPool &operator=(const ProcessPool &other) = delete;
+
+    ~ProcessPool();
+
+    /**
+     * Returns false if the shared memory could not be allocated.
+     */
+    bool isReady() const {
+        return mapped != nullptr;
+    }
+
+    /**
+     * Runs all of the tasks in the worker processes and returns once they are all done.
+     * Returns the tasks that their worker died while running them, @param onTaskDone is called for the rest. Only the
+     * slots of the returned tasks can be read afterwards if @param onTaskDone is given.
+     */
+    vector<FailedTask> run(const TaskFunc &runTask, const BudgetFunc &taskBudget = nullptr,
+                           const DoneFunc &onTaskDone = nullptr);
+
+    const char *getSlot(int task) const;
+
+    /**
+     * Returns a short description of the given wait status of a worker that died.
+     */
+    static std::string describeStatus(int status);
+};
+
+#endif //SHIPPROJECT_PROCESSPOOL_H
@@ -0,0 +1,80 @@
+#ifndef SHIPPROJECT_RESULTCELL_H
+#define SHIPPROJECT_RESULTCELL_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define CACHE_LINE_SIZE 64
+
+/**
+ * The kinds of the errors a simulation finds, each one has its own message (see Simulation::formatError).
+ */
+enum class ErrorKind : unsigned char {
+    Text, // A message that is ready, kept as the subject
+    AlgorithmReported, // The value is the index of the error code the algorithm returned
+    MissedDestination, // Containers were left on the ship after their destination port
+    InvalidInstruction, InvalidContainerId,
+    LoadIllegalWeight, LoadIllegalDestination, LoadIdOnShip, LoadInvalidContainer, LoadOutOfRange, LoadFullShip,
+    LoadUnavailableSpot, LoadUnavailableContainer, LoadDuplicatedId, LoadAlreadyOnShip, LoadDestIsCurrentPort,
+    LoadDestNotInRoute, LoadUnbalances, LoadAboveEmptySpot,
+    UnloadOutOfRange, UnloadEmptySpot, UnloadWrongSpot, UnloadUnbalances, UnloadContainerAbove,
+    MoveOutOfRange, MoveSameXY, MoveUnavailableSpot, MoveWrongSpot, MoveUnbalances, MoveContainerAbove,
+    MoveAboveEmptySpot,
+    RejectNotInPort, RejectAlreadyLoaded, RejectLoadable,
+    RejectedLoadable, RejectedFartherLoaded, LeftAtWrongPort, LeftWithoutInstruction, LeftFartherLoaded,
+    DuplicateNotRejected
+};
+
+/**
+ * An error a simulation found, kept compact while the simulation runs and formatted to text only once its cell is
+ * collected. Containers IDs and ports names are short enough to be kept inline by the string, with no allocation.
+ */
+struct ErrorRecord {
+    ErrorKind kind = ErrorKind::Text;
+    int port_index = -1; // The port's index in the route, -1 if the error is not related to a port
+    string subject; // The container's ID (or port name) the error is about, or the message of a Text error
+    int floor = -1, x = -1, y = -1; // The position in the instruction, if there is one
+    int value = 0; // A number the message needs, e.g. the illegal weight
+};
+
+/**
+ * The errors of a single kind that were left out once the cell had as many errors as it may keep.
+ */
+struct DroppedErrors {
+    int count = 0;
+    ErrorRecord first;
+    ErrorRecord last;
+};
+
+/**
+ * The results of a single algorithm-travel pair, owned by the task that runs its simulation.
+ * The task writes to it with no lock, and the simulator collects it into the matrices once the tasks are done.
+ * Each cell starts on a cache line of its own, so tasks that run side by side don't write to the same line.
+ */
+struct alignas(CACHE_LINE_SIZE) ResultCell {
+    enum State {
+        Empty, // No simulation has finished writing to the cell
+        Done, // The simulation is done, nothing else is written to the cell
+        Abandoned // The task was given up while still running, only timeout_error may be read
+    };
+
+    string num_of_op = "0";
+    bool err_in_travel = false;
+    long duration = -1;
+    vector<ErrorRecord> errors;
+    // Counted by their kind, once the errors cap was reached. Each error code an algorithm reports is a kind of its
+    // own, so the value is part of the key for AlgorithmReported (and 0 for any other kind)
+    std::map<std::pair<ErrorKind, int>, DroppedErrors> dropped_errors;
+    std::shared_ptr<const vector<string>> ports_names; // The route the port indexes of the errors refer to
+    string timeout_error; // Written by the watchdog's thread, before the state is set to Abandoned
+    std::atomic<State> state{Empty};
+};
+
+#endif //SHIPPROJECT_RESULTCELL_H
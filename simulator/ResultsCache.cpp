@@ -0,0 +1,161 @@
+#include "ResultsCache.h"
+#include <algorithm>
+#include <fstream>
+#include <unistd.h>
+
+#define ENTRY_FILE_NAME "entry"
+#define INSTRUCTIONS_DIR_NAME "instructions"
+#define HASH_CHUNK_SIZE (64 * 1024)
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/**
+ * Adds the given bytes to a 64 bit FNV-1a hash.
+ */
+uint64_t addToHash(uint64_t hash, const char *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char) data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Returns the hash as 16 hex digits.
+ */
+string hashToHex(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    string hex(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        hex[i] = digits[hash & 0xf];
+    }
+    return hex;
+}
+
+bool ResultsCache::open(const string &dir) {
+    std::error_code err;
+    std::filesystem::create_directories(dir, err);
+    if (!std::filesystem::is_directory(dir, err))
+        return false;
+    cacheDir = dir;
+    return true;
+}
+
+string ResultsCache::getEntryDir(const string &key) const {
+    return (std::filesystem::path(cacheDir) / hashToHex(addToHash(FNV_OFFSET_BASIS, key.data(), key.size()))).string();
+}
+
+uint64_t ResultsCache::hashFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return 0;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    vector<char> chunk(HASH_CHUNK_SIZE);
+    while (file) {
+        file.read(chunk.data(), (std::streamsize) chunk.size());
+        hash = addToHash(hash, chunk.data(), (size_t) file.gcount());
+    }
+    return hash;
+}
+
+uint64_t ResultsCache::hashDir(const std::filesystem::path &dir) {
+    vector<std::filesystem::path> files;
+    std::error_code err;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, err)) {
+        if (entry.is_regular_file(err))
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end()); // The order the folder is listed in doesn't matter
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (auto &file : files) {
+        string name = file.filename().string();
+        uint64_t file_hash = hashFile(file);
+        hash = addToHash(hash, name.data(), name.size() + 1); // With its terminating null, as a separator
+        hash = addToHash(hash, reinterpret_cast<const char *>(&file_hash), sizeof(file_hash));
+    }
+    return hash;
+}
+
+string ResultsCache::makeKey(const string &algoName, uint64_t algoHash, const string &travelName, uint64_t travelHash,
+                             const string &settings) {
+    return "v" + std::to_string(RESULTS_CACHE_VERSION) + "|" + hashToHex(algoHash) + "|" + hashToHex(travelHash) + "|" +
+           settings + "|" + algoName + "|" + travelName;
+}
+
+bool ResultsCache::load(const string &key, Entry &entry, const string &instructionsDir) const {
+    std::filesystem::path entry_dir = getEntryDir(key);
+    std::ifstream entry_file(entry_dir / ENTRY_FILE_NAME);
+    if (!entry_file.is_open())
+        return false;
+    string line;
+    if (!std::getline(entry_file, line) || line != "key," + key)
+        return false; // Another key with the same hash
+    bool result_found = false;
+    entry.errors.clear();
+    while (std::getline(entry_file, line)) {
+        if (line.rfind("result,", 0) == 0) {
+            // result,<error in travel>,<duration>,<number of operations>
+            size_t duration_pos = line.find(',', 7), ops_pos = line.find(',', duration_pos + 1);
+            if (duration_pos == string::npos || ops_pos == string::npos)
+                return false;
+            entry.errInTravel = line.substr(7, duration_pos - 7) == "1";
+            entry.duration = std::strtol(line.c_str() + duration_pos + 1, nullptr, 10);
+            entry.numOfOp = line.substr(ops_pos + 1);
+            result_found = true;
+        } else if (line.rfind("error,", 0) == 0) {
+            entry.errors.push_back(line.substr(6));
+        }
+    }
+    if (!result_found)
+        return false; // Broken entry
+    std::error_code err;
+    if (instructionsDir.empty())
+        return true;
+    for (const auto &file : std::filesystem::directory_iterator(entry_dir / INSTRUCTIONS_DIR_NAME, err)) {
+        std::filesystem::copy_file(file.path(), std::filesystem::path(instructionsDir) / file.path().filename(),
+                                   std::filesystem::copy_options::overwrite_existing, err);
+        if (err)
+            return false;
+    }
+    return !err;
+}
+
+bool ResultsCache::store(const string &key, const Entry &entry, const string &instructionsDir) {
+    std::filesystem::path entry_dir = getEntryDir(key);
+    std::error_code err;
+    if (std::filesystem::exists(entry_dir, err))
+        return true; // Cached by another pair (or run) meanwhile
+    // Written aside and renamed into place, so a reader never sees a partly written entry
+    std::filesystem::path temp_dir = std::filesystem::path(cacheDir) /
+                                     (".tmp." + std::to_string(getpid()) + "." + std::to_string(nextTempDir++));
+    std::filesystem::create_directories(temp_dir / INSTRUCTIONS_DIR_NAME, err);
+    bool written = !err;
+    if (!instructionsDir.empty()) { // Otherwise the entry is kept without files
+        for (const auto &file : std::filesystem::directory_iterator(instructionsDir, err)) {
+            if (!written)
+                break;
+            std::filesystem::copy_file(file.path(), temp_dir / INSTRUCTIONS_DIR_NAME / file.path().filename(),
+                                       std::filesystem::copy_options::overwrite_existing, err);
+            written = !err;
+        }
+        written = written && !err;
+    }
+    if (written) {
+        std::ofstream entry_file(temp_dir / ENTRY_FILE_NAME, std::ios::out | std::ios::trunc);
+        entry_file << "key," << key << "\n";
+        entry_file << "result," << (entry.errInTravel ? "1," : "0,") << entry.duration << "," << entry.numOfOp << "\n";
+        for (auto &msg : entry.errors) {
+            entry_file << "error," << msg << "\n";
+        }
+        entry_file.close();
+        written = !entry_file.fail();
+    }
+    if (written)
+        std::filesystem::rename(temp_dir, entry_dir, err);
+    if (!written || err) { // The entry may have been renamed into place by another writer meanwhile
+        std::filesystem::remove_all(temp_dir, err);
+        return std::filesystem::exists(entry_dir, err);
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * The results cache class, keeps the outcome of each algorithm-travel pair that was simulated in a folder that is
+ * shared by the runs: its results, its errors and its crane instructions files. An entry is keyed by the contents of
+ * the pair's inputs (the algorithm's shared object and the files of the travel folder), so a pair whose inputs didn't
+ * change since it was cached is served from the cache instead of being simulated again.
+ * Entries are written aside and renamed into place, so runs (and worker processes) may share the cache.
+ */
+
+#ifndef SHIPPROJECT_RESULTSCACHE_H
+#define SHIPPROJECT_RESULTSCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define RESULTS_CACHE_VERSION 1 // Changed whenever the simulator reports a pair differently, so old entries are missed
+
+class ResultsCache {
+public:
+    /**
+     * The outcome of a pair, as it's kept in the cache.
+     */
+    struct Entry {
+        bool errInTravel = false;
+        long duration = -1; // Running time of the simulation that was cached, in microseconds
+        string numOfOp;
+        vector<string> errors; // The formatted messages, in their order
+    };
+
+private:
+    string cacheDir;
+    std::atomic_int nextTempDir{0}; // Numbers the folders the entries are written to before they are renamed
+
+    string getEntryDir(const string &key) const;
+
+public:
+    ResultsCache() = default;
+
+    ResultsCache(const ResultsCache &other) = delete;
+
+    ResultsCache &operator=(const ResultsCache &other) = delete;
+
+    /**
+     * Uses the given folder as the cache, it's created if it doesn't exist. Returns false if it can't be used.
+     */
+    bool open(const string &dir);
+
+    bool isOpen() const {
+        return !cacheDir.empty();
+    }
+
+    /**
+     * Returns the hash of the file's contents, 0 if it can't be read.
+     */
+    static uint64_t hashFile(const std::filesystem::path &path);
+
+    /**
+     * Returns the hash of the names and the contents of the regular files in the folder.
+     */
+    static uint64_t hashDir(const std::filesystem::path &dir);
+
+    /**
+     * Returns the key of a pair: everything its outcome depends on. @param settings are the run's settings that change
+     * the pair's messages.
+     */
+    static string makeKey(const string &algoName, uint64_t algoHash, const string &travelName, uint64_t travelHash,
+                          const string &settings);
+
+    /**
+     * Reads the entry of the given key and copies its crane instructions files to @param instructionsDir, they aren't
+     * copied if it's empty. Returns false if there is no such entry (or it can't be read), the pair should be simulated in that case.
+     */
+    bool load(const string &key, Entry &entry, const string &instructionsDir) const;
+
+    /**
+     * Adds an entry for the given key, with the crane instructions files in @param instructionsDir (none if it's
+     * empty). An entry that already exists is kept. Returns false if the entry couldn't be written.
+     */
+    bool store(const string &key, const Entry &entry, const string &instructionsDir);
+};
+
+#endif //SHIPPROJECT_RESULTSCACHE_H
@@ -0,0 +1,95 @@
+#include "ResultsJournal.h"
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+bool ResultsJournal::open(const string &journalPath, const string &statusPath, const vector<string> &algosNames,
+                          const vector<string> &travelsNames, int numOfPairs, const string &doneRecords,
+                          int numOfDonePairs) {
+    string tempPath = journalPath + ".tmp";
+    journal.open(tempPath, std::ios::out | std::ios::trunc);
+    if (!journal.is_open())
+        return false;
+    this->statusPath = statusPath;
+    this->numOfPairs = numOfPairs;
+    startedPairs = donePairs = numOfDonePairs;
+    startTime = Clock::now();
+    // Names are always the last field of a line, so they may contain commas
+    for (auto &name : algosNames) {
+        journal << "algo," << name << "\n";
+    }
+    for (auto &name : travelsNames) {
+        journal << "travel," << name << "\n";
+    }
+    journal << doneRecords;
+    journal.close();
+    if (journal.fail())
+        return false;
+    std::error_code err;
+    std::filesystem::rename(tempPath, journalPath, err);
+    if (err)
+        return false;
+    journal.open(journalPath, std::ios::out | std::ios::app);
+    writeStatus(false, true);
+    return journal.is_open();
+}
+
+void ResultsJournal::append(const string &records, int pairs) {
+    {
+        std::lock_guard<mutex> lock(journalMutex);
+        if (!journal.is_open())
+            return;
+        journal << records;
+        journal.flush(); // Nothing is lost if the run is killed from now on
+    }
+    donePairs += pairs;
+    writeStatus(false, false);
+}
+
+void ResultsJournal::close() {
+    {
+        std::lock_guard<mutex> lock(journalMutex);
+        if (!journal.is_open())
+            return;
+        journal.close();
+    }
+    writeStatus(true, true);
+}
+
+void ResultsJournal::writeStatus(bool finished, bool force) {
+    if (statusPath.empty())
+        return;
+    auto now = Clock::now();
+    Clock::rep last = lastStatusTime;
+    if (!force && (now.time_since_epoch().count() - last < Clock::duration(STATUS_INTERVAL).count() ||
+                   !lastStatusTime.compare_exchange_strong(last, now.time_since_epoch().count())))
+        return; // Written lately, or another thread is writing it right now
+    std::lock_guard<mutex> lock(statusMutex);
+    lastStatusTime = now.time_since_epoch().count();
+    int done = donePairs, started = startedPairs, total = numOfPairs;
+    double seconds = std::chrono::duration<double>(now - startTime).count();
+    double throughput = seconds > 0 ? done / seconds * 60 : 0; // Pairs per minute
+    std::ostringstream status;
+    status << std::fixed << std::setprecision(1);
+    status << "state," << (finished ? "finished" : "running") << "\n";
+    status << "done," << done << "\n";
+    status << "in_flight," << std::max(started - done, 0) << "\n";
+    status << "queued," << std::max(total - started, 0) << "\n";
+    status << "elapsed_seconds," << seconds << "\n";
+    status << "pairs_per_minute," << throughput << "\n";
+    if (done > 0)
+        status << "eta_seconds," << std::max(total - done, 0) / throughput * 60 << "\n";
+    else
+        status << "eta_seconds,unknown\n";
+    // Written aside and renamed over the old one, so a reader never sees a partly written file
+    string tempPath = statusPath + ".tmp";
+    {
+        std::ofstream tempFile(tempPath, std::ios::out | std::ios::trunc);
+        if (!tempFile.is_open())
+            return;
+        tempFile << status.str();
+    }
+    std::error_code err;
+    std::filesystem::rename(tempPath, statusPath, err);
+}
@@ -0,0 +1,89 @@
+/**
+ * The results journal class, appends the records of the simulations to a file in the output folder as soon as they
+ * are done, so a long run that is killed keeps what it has done. The final output files are assembled from it, and a
+ * run that is resumed reads the pairs that are done from it.
+ * It also keeps a status file, which is replaced atomically with the number of simulations that are done, in flight
+ * and queued, the throughput and the estimated time left.
+ */
+
+#ifndef SHIPPROJECT_RESULTSJOURNAL_H
+#define SHIPPROJECT_RESULTSJOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::mutex;
+
+#define STATUS_INTERVAL std::chrono::seconds(1) // The status file is replaced at most once in this interval
+
+class ResultsJournal {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    std::ofstream journal;
+    string statusPath;
+    mutex journalMutex;
+    mutex statusMutex; // The status file is written by one thread at a time
+    Clock::time_point startTime;
+    std::atomic<Clock::rep> lastStatusTime{0}; // When the status file was written, in steady clock ticks
+    std::atomic_int numOfPairs{0}; // The pairs that are expected to run
+    std::atomic_int startedPairs{0};
+    std::atomic_int donePairs{0};
+
+    /**
+     * Writes the status file, unless it was written less than STATUS_INTERVAL ago (or @param force is true).
+     */
+    void writeStatus(bool finished, bool force);
+
+public:
+    ResultsJournal() = default;
+
+    ResultsJournal(const ResultsJournal &other) = delete;
+
+    ResultsJournal &operator=(const ResultsJournal &other) = delete;
+
+    /**
+     * Creates the journal with the given names of the algorithms and the travels, the records refer to them by their
+     * numbers (counted from 1). @param doneRecords are the records of @param numOfDonePairs pairs that were done
+     * before, e.g. by a run that is resumed. Returns false if the journal can't be written.
+     * The journal replaces the previous one only once it's written, so the done pairs are never lost meanwhile.
+     */
+    bool open(const string &journalPath, const string &statusPath, const vector<string> &algosNames,
+              const vector<string> &travelsNames, int numOfPairs, const string &doneRecords = "",
+              int numOfDonePairs = 0);
+
+    bool isOpen() const {
+        return journal.is_open();
+    }
+
+    /**
+     * Changes the number of the pairs that are expected to run, e.g. when a travel turns out to have a fatal error.
+     */
+    void addPairs(int pairs) {
+        numOfPairs += pairs;
+    }
+
+    void pairsStarted(int pairs) {
+        startedPairs += pairs;
+        writeStatus(false, false);
+    }
+
+    /**
+     * Appends the records of @param pairs pairs that are done, as a single block. May be called from any thread.
+     */
+    void append(const string &records, int pairs);
+
+    /**
+     * Writes the final status and closes the journal.
+     */
+    void close();
+};
+
+#endif //SHIPPROJECT_RESULTSJOURNAL_H
@@ -0,0 +1,210 @@
+#include "ResultsStore.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+ResultsStore::~ResultsStore() {
+    release();
+}
+
+void ResultsStore::release() {
+    if (mappedSize > 0)
+        munmap(base, mappedSize);
+    mappedSize = 0;
+    base = nullptr;
+    buffer.clear();
+    algosNames.clear();
+    travelsNames.clear();
+    numOfAlgos = numOfTravels = 0;
+}
+
+size_t ResultsStore::columnsSize(size_t numOfPairs, size_t numOfTravels) {
+    // The wider columns come first, so each column is aligned to its type
+    return numOfPairs * (2 * sizeof(int64_t) + sizeof(int32_t) + sizeof(uint8_t)) + numOfTravels * sizeof(uint8_t);
+}
+
+void ResultsStore::create(const vector<string> &algos, const vector<string> &travels) {
+    release();
+    size_t namesOffset = sizeof(Header) + columnsSize(algos.size() * travels.size(), travels.size());
+    size_t size = namesOffset;
+    for (auto &names : {&algos, &travels}) {
+        for (auto &name : *names) {
+            size += sizeof(uint32_t) + name.size();
+        }
+    }
+    buffer.assign(size, 0);
+    base = buffer.data();
+    Header header{};
+    memcpy(header.magic, RESULTS_STORE_MAGIC, sizeof(header.magic));
+    header.version = RESULTS_STORE_VERSION;
+    header.numOfAlgos = (uint32_t) algos.size();
+    header.numOfTravels = (uint32_t) travels.size();
+    header.namesOffset = namesOffset;
+    header.size = size;
+    memcpy(base, &header, sizeof(Header));
+    char *name_pos = base + namesOffset;
+    for (auto &names : {&algos, &travels}) {
+        for (auto &name : *names) {
+            auto length = (uint32_t) name.size();
+            memcpy(name_pos, &length, sizeof(uint32_t));
+            memcpy(name_pos + sizeof(uint32_t), name.data(), length);
+            name_pos += sizeof(uint32_t) + length;
+        }
+    }
+    layOut(size);
+    std::fill(durations, durations + (size_t) numOfAlgos * numOfTravels, -1);
+}
+
+bool ResultsStore::layOut(size_t size) {
+    if (size < sizeof(Header))
+        return false;
+    Header header{};
+    memcpy(&header, base, sizeof(Header));
+    if (memcmp(header.magic, RESULTS_STORE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RESULTS_STORE_VERSION || header.size != size)
+        return false;
+    size_t numOfPairs = (size_t) header.numOfAlgos * header.numOfTravels;
+    if (header.namesOffset != sizeof(Header) + columnsSize(numOfPairs, header.numOfTravels) ||
+        header.namesOffset > size)
+        return false;
+    numOfAlgos = (int) header.numOfAlgos;
+    numOfTravels = (int) header.numOfTravels;
+    char *column = base + sizeof(Header);
+    numsOfOps = reinterpret_cast<int64_t *>(column);
+    durations = numsOfOps + numOfPairs;
+    numsOfErrors = reinterpret_cast<int32_t *>(durations + numOfPairs);
+    pairsFlags = reinterpret_cast<uint8_t *>(numsOfErrors + numOfPairs);
+    travelsFlags = pairsFlags + numOfPairs;
+    // The names are copied out, they are few and used as strings
+    size_t name_pos = header.namesOffset;
+    for (auto names : {std::make_pair(&algosNames, numOfAlgos), std::make_pair(&travelsNames, numOfTravels)}) {
+        names.first->clear();
+        for (int i = 0; i < names.second; ++i) {
+            uint32_t length;
+            if (name_pos + sizeof(uint32_t) > size)
+                return false;
+            memcpy(&length, base + name_pos, sizeof(uint32_t));
+            name_pos += sizeof(uint32_t);
+            if (name_pos + length > size)
+                return false;
+            names.first->emplace_back(base + name_pos, length);
+            name_pos += length;
+        }
+    }
+    return name_pos == size;
+}
+
+bool ResultsStore::map(const string &path) {
+    release();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t) sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    void *area = mmap(nullptr, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid without the file descriptor
+    if (area == MAP_FAILED)
+        return false;
+    base = static_cast<char *>(area);
+    mappedSize = (size_t) file_stat.st_size;
+    if (!layOut(mappedSize)) {
+        release();
+        return false;
+    }
+    return true;
+}
+
+bool ResultsStore::writeFile(const string &path) const {
+    if (base == nullptr)
+        return false;
+    Header header{};
+    memcpy(&header, base, sizeof(Header));
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file.write(base, (std::streamsize) header.size);
+    return !file.fail();
+}
+
+vector<ResultsStore::Ranking> ResultsStore::rankAlgorithms() const {
+    vector<Ranking> rankings;
+    for (int numOfAlgo = 1; numOfAlgo <= numOfAlgos; ++numOfAlgo) {
+        Ranking ranking{numOfAlgo, 0, 0, false};
+        int num_of_runs = 0, num_of_skipped = 0; // Pairs that didn't run aren't counted at all
+        for (int numOfTravel = 1; numOfTravel <= numOfTravels; ++numOfTravel) {
+            if (isTravelRemoved(numOfTravel))
+                continue;
+            if (!hasRun(numOfAlgo, numOfTravel)) {
+                num_of_skipped++;
+                continue;
+            }
+            num_of_runs++;
+            if (hasError(numOfAlgo, numOfTravel))
+                ranking.num_of_errors++;
+            else
+                ranking.sum_of_ops += getNumOfOps(numOfAlgo, numOfTravel);
+        }
+        ranking.idle = num_of_runs == 0 && num_of_skipped > 0;
+        rankings.push_back(ranking);
+    }
+    std::stable_sort(rankings.begin(), rankings.end(), [](const Ranking &r1, const Ranking &r2) {
+        if (r1.idle != r2.idle) // Idle algorithms come last
+            return r2.idle;
+        if (r1.num_of_errors != r2.num_of_errors) // Sort by number of errors, if there is difference
+            return r1.num_of_errors < r2.num_of_errors;
+        return r1.sum_of_ops < r2.sum_of_ops; // Sort by sum of actions in case of errors tie
+    });
+    return rankings;
+}
+
+bool ResultsStore::exportResults(const string &path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    string row = "RESULTS,";
+    for (int numOfTravel = 1; numOfTravel <= numOfTravels; ++numOfTravel) {
+        if (!isTravelRemoved(numOfTravel))
+            row += travelsNames[numOfTravel - 1] + ",";
+    }
+    row += "Sum,Num Errors\n";
+    file << row;
+    for (auto &ranking : rankAlgorithms()) {
+        row = algosNames[ranking.num_of_algo - 1] + ",";
+        for (int numOfTravel = 1; numOfTravel <= numOfTravels; ++numOfTravel) {
+            if (isTravelRemoved(numOfTravel))
+                continue;
+            if (hasRun(ranking.num_of_algo, numOfTravel))
+                row += std::to_string(getNumOfOps(ranking.num_of_algo, numOfTravel));
+            row += ",";
+        }
+        if (!ranking.idle)
+            row += std::to_string(ranking.sum_of_ops) + "," + std::to_string(ranking.num_of_errors);
+        else
+            row += ",";
+        row += "\n";
+        file << row;
+    }
+    return !file.fail();
+}
+
+bool ResultsStore::exportRankings(const string &path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file << "Rank,Algorithm,Num Errors,Sum\n";
+    int rank = 1;
+    for (auto &ranking : rankAlgorithms()) {
+        if (ranking.idle)
+            continue;
+        file << rank++ << "," << algosNames[ranking.num_of_algo - 1] << "," << ranking.num_of_errors << ","
+             << ranking.sum_of_ops << "\n";
+    }
+    return !file.fail();
+}
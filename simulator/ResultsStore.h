@@ -0,0 +1,192 @@
+/**
+ * The results store class, keeps the results of the algorithm-travel pairs as typed columns: the number of
+ * operations, the running time, the number of errors and the flags of each pair, one column after the other with the
+ * pairs ordered by the algorithm and then by the travel.
+ * The store is laid out in memory exactly as it is written to its file, so a file of a previous run is memory mapped
+ * and queried as is, without parsing. The results file and the rankings are exported from it.
+ */
+
+#ifndef SHIPPROJECT_RESULTSSTORE_H
+#define SHIPPROJECT_RESULTSSTORE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define RESULTS_STORE_MAGIC "SIMSTORE" // The first bytes of a store file
+#define RESULTS_STORE_VERSION 1
+
+class ResultsStore {
+public:
+    // Flags of a pair
+    enum PairFlags : uint8_t {
+        ErrorInTravel = 1, // The travel ended with an error, its number of operations is -1
+        Ran = 2 // The pair's results were recorded
+    };
+
+    // Flags of a travel
+    enum TravelFlags : uint8_t {
+        Removed = 1 // The travel had a fatal error or belongs to another shard, it's left out of the results
+    };
+
+    /**
+     * The place of an algorithm in the rankings.
+     */
+    struct Ranking {
+        int num_of_algo;
+        int num_of_errors; // Travels that ended with an error
+        long sum_of_ops; // Operations of the travels that didn't end with an error
+        bool idle; // The algorithm ran none of the travels of the results, so it isn't ranked by them
+    };
+
+private:
+    // The beginning of the store, followed by the columns and then by the names
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t numOfAlgos;
+        uint32_t numOfTravels;
+        uint32_t reserved;
+        uint64_t namesOffset; // The names are kept as a 32 bit length followed by the characters
+        uint64_t size; // The size of the whole store
+    };
+
+    vector<char> buffer; // The store, unless it's mapped
+    char *base = nullptr;
+    size_t mappedSize = 0; // Not 0 if the store is a mapped file, which is read only
+    int numOfAlgos = 0;
+    int numOfTravels = 0;
+    int64_t *numsOfOps = nullptr;
+    int64_t *durations = nullptr; // In microseconds, -1 if the pair didn't run
+    int32_t *numsOfErrors = nullptr;
+    uint8_t *pairsFlags = nullptr;
+    uint8_t *travelsFlags = nullptr;
+    vector<string> algosNames;
+    vector<string> travelsNames;
+
+    /**
+     * Sets the columns pointers by the layout of the store that starts at base, returns false if it's broken.
+     */
+    bool layOut(size_t size);
+
+    /**
+     * Returns the sizes of the columns, by their order in the store.
+     */
+    static size_t columnsSize(size_t numOfPairs, size_t numOfTravels);
+
+    void release();
+
+    size_t pairIndex(int numOfAlgo, int numOfTravel) const {
+        return (size_t) (numOfAlgo - 1) * numOfTravels + (numOfTravel - 1);
+    }
+
+public:
+    ResultsStore() = default;
+
+    ResultsStore(const ResultsStore &other) = delete;
+
+    ResultsStore &operator=(const ResultsStore &other) = delete;
+
+    ~ResultsStore();
+
+    /**
+     * Creates an empty store in memory for the given algorithms and travels, which are numbered from 1 by their order.
+     */
+    void create(const vector<string> &algos, const vector<string> &travels);
+
+    /**
+     * Maps the store file in the given path, read only. Returns false if it can't be read or it isn't a store file.
+     */
+    bool map(const string &path);
+
+    /**
+     * Writes the store to the given path, returns false if it couldn't be written.
+     */
+    bool writeFile(const string &path) const;
+
+    int getNumOfAlgos() const {
+        return numOfAlgos;
+    }
+
+    int getNumOfTravels() const {
+        return numOfTravels;
+    }
+
+    const string &getAlgoName(int numOfAlgo) const {
+        return algosNames[numOfAlgo - 1];
+    }
+
+    const string &getTravelName(int numOfTravel) const {
+        return travelsNames[numOfTravel - 1];
+    }
+
+    long getNumOfOps(int numOfAlgo, int numOfTravel) const {
+        return (long) numsOfOps[pairIndex(numOfAlgo, numOfTravel)];
+    }
+
+    long getDuration(int numOfAlgo, int numOfTravel) const {
+        return (long) durations[pairIndex(numOfAlgo, numOfTravel)];
+    }
+
+    int getNumOfErrors(int numOfAlgo, int numOfTravel) const {
+        return numsOfErrors[pairIndex(numOfAlgo, numOfTravel)];
+    }
+
+    bool hasError(int numOfAlgo, int numOfTravel) const {
+        return pairsFlags[pairIndex(numOfAlgo, numOfTravel)] & ErrorInTravel;
+    }
+
+    bool hasRun(int numOfAlgo, int numOfTravel) const {
+        return pairsFlags[pairIndex(numOfAlgo, numOfTravel)] & Ran;
+    }
+
+    bool isTravelRemoved(int numOfTravel) const {
+        return travelsFlags[numOfTravel - 1] & Removed;
+    }
+
+    // The setters may be used only on a store that was created in memory
+
+    void setResult(int numOfAlgo, int numOfTravel, long numOfOps, bool errorInTravel) {
+        size_t pair = pairIndex(numOfAlgo, numOfTravel);
+        numsOfOps[pair] = errorInTravel ? -1 : numOfOps;
+        pairsFlags[pair] = Ran | (errorInTravel ? ErrorInTravel : 0);
+    }
+
+    void setDuration(int numOfAlgo, int numOfTravel, long duration) {
+        durations[pairIndex(numOfAlgo, numOfTravel)] = duration;
+    }
+
+    void addError(int numOfAlgo, int numOfTravel) {
+        numsOfErrors[pairIndex(numOfAlgo, numOfTravel)]++;
+    }
+
+    void markTravelRemoved(int numOfTravel) {
+        travelsFlags[numOfTravel - 1] |= Removed;
+    }
+
+    /**
+     * Returns the algorithms by their rank: the fewest travels that ended with an error first, and on a tie the
+     * fewest operations. Algorithms that tie on both keep their order, and algorithms that didn't run any of the
+     * travels come last.
+     */
+    vector<Ranking> rankAlgorithms() const;
+
+    /**
+     * Writes the results file: a row for each algorithm by its rank, with the operations of each travel that isn't
+     * removed, their sum and the number of travels that ended with an error. The cells of pairs that didn't run are
+     * left empty, as are the sum and the errors of an algorithm that didn't run any of them.
+     */
+    bool exportResults(const string &path) const;
+
+    /**
+     * Writes the rankings file: the rank, the name, the number of travels that ended with an error and the sum of the
+     * operations of each algorithm that ran any of the travels.
+     */
+    bool exportRankings(const string &path) const;
+};
+
+#endif //SHIPPROJECT_RESULTSSTORE_H
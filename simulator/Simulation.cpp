@@ -1,9 +1,5 @@
 #include "Simulation.h"
 
-enum InstructionType {
-    Command = 0, ContainerID = 1, FloorNum = 2, X = 3, Y = 4, DestFloorNum = 5, DestX = 6, DestY = 7
-};
-
 inline static map<int, string> errCodes = {{0,  "ship plan: a position has an equal number of floors or more than the number of floors provided in the first line (ignored)"},
                                            {1,  "ship plan: a given position exceeds the X/Y ship limits (ignored)"},
                                            {2,  "ship plan: bad line format after first line or duplicate x,y appearance with same data (ignored)"},
@@ -25,14 +21,71 @@ inline static map<int, string> errCodes = {{0,  "ship plan: a position has an eq
                                            {18, "containers at port: total containers amount exceeds ship capacity (rejecting far containers)"}};
 
 
-Simulation::Simulation(ShipPlan &plan, Route &route, WeightBalanceCalculator &wcalc)
-        : ship(plan), travel(route), calc(wcalc), err_in_travel(false) {
+/**
+ * How the message of an error kind is built: "@ Travel: <travel>- Port: <port>" + before + the field + after.
+ */
+struct ErrorFormat {
+    enum Field {
+        None, Subject, Value
+    };
+    const char *before;
+    Field field;
+    const char *after;
+};
+
+inline static map<ErrorKind, ErrorFormat> errFormats = {
+        {ErrorKind::InvalidInstruction,       {"- Invalid instruction detected.",                                                     ErrorFormat::None,    ""}},
+        {ErrorKind::InvalidContainerId,       {"- Instruction with invalid container ID detected.",                                   ErrorFormat::None,    ""}},
+        {ErrorKind::LoadIllegalWeight,        {"- Trying to load a container with illegal weight: ",                                  ErrorFormat::Value,   ""}},
+        {ErrorKind::LoadIllegalDestination,   {"- Trying to load a container with illegal destination port: ",                        ErrorFormat::Subject, ""}},
+        {ErrorKind::LoadIdOnShip,             {"- Trying to load a container which it's ID already exists on the ship: ",             ErrorFormat::Subject, ""}},
+        {ErrorKind::LoadInvalidContainer,     {"- Trying to load an invalid container.",                                              ErrorFormat::None,    ""}},
+        {ErrorKind::LoadOutOfRange,           {"- Load a container in Out-Of-Range position.",                                        ErrorFormat::None,    ""}},
+        {ErrorKind::LoadFullShip,             {"- Load a container in a full ship.",                                                  ErrorFormat::None,    ""}},
+        {ErrorKind::LoadUnavailableSpot,      {"- Load a container in an unavailable spot.",                                          ErrorFormat::None,    ""}},
+        {ErrorKind::LoadUnavailableContainer, {"- Trying to load an unavailable container.",                                          ErrorFormat::None,    ""}},
+        {ErrorKind::LoadDuplicatedId,         {"- Trying to load a container with a duplicated ID: ",                                 ErrorFormat::Subject, ""}},
+        {ErrorKind::LoadAlreadyOnShip,        {"- Trying to load a container that is already on the ship.",                           ErrorFormat::None,    ""}},
+        {ErrorKind::LoadDestIsCurrentPort,    {"- Load a container that its destination is the current port.",                        ErrorFormat::None,    ""}},
+        {ErrorKind::LoadDestNotInRoute,       {"- Load a container that its destination is not within the remaining route.",          ErrorFormat::None,    ""}},
+        {ErrorKind::LoadUnbalances,           {"- Load a container that un-balances the ship.",                                       ErrorFormat::None,    ""}},
+        {ErrorKind::LoadAboveEmptySpot,       {"- Load a container in a spot that's above an empty spot.",                            ErrorFormat::None,    ""}},
+        {ErrorKind::UnloadOutOfRange,         {"- Unload a container with ID: ", ErrorFormat::Subject, "- from Out-Of-Range position."}},
+        {ErrorKind::UnloadEmptySpot,          {"- Unload a container with ID: ", ErrorFormat::Subject, "- from an unavailable or empty spot."}},
+        {ErrorKind::UnloadWrongSpot,          {"- Unload a container with ID: ", ErrorFormat::Subject, "- that isn't in the given spot."}},
+        {ErrorKind::UnloadUnbalances,         {"- Unload a container with ID: ", ErrorFormat::Subject, "- from from the ship unbalance it."}},
+        {ErrorKind::UnloadContainerAbove,     {"- Unload a container with ID: ", ErrorFormat::Subject, "- while there's a container above it."}},
+        {ErrorKind::MoveOutOfRange,           {"- Move a container with ID: ",   ErrorFormat::Subject, "- using Out-Of-Range position."}},
+        {ErrorKind::MoveSameXY,               {"- Move a container with ID: ",   ErrorFormat::Subject, "- to a spot with the same X,Y but at different floor."}},
+        {ErrorKind::MoveUnavailableSpot,      {"- Move a container with ID: ",   ErrorFormat::Subject, "- using unavailable spot."}},
+        {ErrorKind::MoveWrongSpot,            {"- Move a container with ID: ",   ErrorFormat::Subject, "- that isn't in the given spot."}},
+        {ErrorKind::MoveUnbalances,           {"- Move a container with ID: ",   ErrorFormat::Subject, "- cause the ship to unbalance."}},
+        {ErrorKind::MoveContainerAbove,       {"- Move a container with ID: ",   ErrorFormat::Subject, "- while there's a container above it."}},
+        {ErrorKind::MoveAboveEmptySpot,       {"- Move a container with ID: ",   ErrorFormat::Subject, "- to a spot that's above an empty spot."}},
+        {ErrorKind::RejectNotInPort,          {"- Reject a container with ID: ", ErrorFormat::Subject, "- that wasn't provided by the port."}},
+        {ErrorKind::RejectAlreadyLoaded,      {"- Reject a container with ID: ", ErrorFormat::Subject, "- that was already loaded."}},
+        {ErrorKind::RejectLoadable,           {"- Reject a container with ID: ", ErrorFormat::Subject, "- although it can be loaded correctly."}},
+        {ErrorKind::RejectedLoadable,         {"- Rejected a container with ID: ", ErrorFormat::Subject, "- although it can be loaded correctly."}},
+        {ErrorKind::RejectedFartherLoaded,    {"- Rejected a container with ID: ", ErrorFormat::Subject,
+                                               "- while another container was loaded and it's destination port is further."}},
+        {ErrorKind::LeftAtWrongPort,          {"- A container with ID: ", ErrorFormat::Subject,
+                                               "- was left in a port that's different from container's destination."}},
+        {ErrorKind::LeftWithoutInstruction,   {"- A container with ID: ", ErrorFormat::Subject,
+                                               "- was left at the port without getting an instruction."}},
+        {ErrorKind::LeftFartherLoaded,        {"- A container with ID: ", ErrorFormat::Subject,
+                                               "- was left in port while another container was loaded and it's destination port is further."}},
+        {ErrorKind::DuplicateNotRejected,     {"- A container with ID: ", ErrorFormat::Subject,
+                                               "- did not get rejected though it has duplicated ID."}}};
+
+Simulation::Simulation(std::shared_ptr<const TravelTemplate> travel_template, WeightBalanceCalculator &wcalc)
+        : travel_template(std::move(travel_template)), calc(wcalc), err_in_travel(false) {
 }
 
 void Simulation::initSimulation(int num_of_algo, int num_of_travel, string &travel_name,
                                 pair<string, std::function<std::unique_ptr<AbstractAlgorithm>()>> &algo_p,
                                 const string &output_path, const string &plan_path,
-                                const string &route_path) {
+                                const string &route_path, ResultCell &cell) {
+    this->result_cell = &cell;
     this->curr_travel_name = travel_name;
     this->output_dir_path = output_path;
     this->num_of_algo = num_of_algo;
@@ -40,104 +93,262 @@ void Simulation::initSimulation(int num_of_algo, int num_of_travel, string &trav
     this->algo_name_and_ctor = algo_p;
     this->plan_path = plan_path;
     this->route_path = route_path;
+    if (travel_template)
+        this->ports_names = std::make_shared<const vector<string>>(travel_template->route.getLeftPortsNames(0));
+    cell.ports_names = this->ports_names;
 
 }
 
-bool Simulation::executeTravel(const string &algo_name, AbstractAlgorithm &algo,
-                               WeightBalanceCalculator &calc, int &num_of_errors) {
-    string instruction_file_path;
-    string instruction_file;
-    int num_of_operations = 0;
-    //Creating instructions directory for the algorithm
-    instruction_file_path = createInstructionDir(output_dir_path, algo_name, curr_travel_name);
-    if (instruction_file_path.empty()) {
-        cout
-                << "ERROR: Failed creating instruction files directory; creates everything inside the output folder."
-                << endl;
-        instruction_file_path = output_dir_path;
-    }
-    while (travel.moveToNextPort(ship)) { // For each port in travel
-        curr_port_name = travel.getCurrentPort().getName();
-        instruction_file =
-                instruction_file_path + std::filesystem::path::preferred_separator + curr_port_name + "_" +
-                to_string(travel.getNumOfVisitsInPort(curr_port_name)) + ".crane_instructions";
-        analyzeErrCode(algo.getInstructionsForCargo(travel.getCurrentPortPath(), instruction_file));
-        iterateInstructions(calc, instruction_file, num_of_operations, num_of_algo);
-        checkMissedContainers(travel.getCurrentPort().getName());
-    }
-    // Check if there was an error by the algorithm. if there was, number of operation is '-1'.
-    if (this->err_in_travel) {
-        num_of_errors++;
-        Simulator::insertResult(num_of_algo, num_of_travel, "-1", true);
-        return false;
-    }
-    Simulator::insertResult(num_of_algo, num_of_travel, to_string(num_of_operations), false);
-    return true;
+void Simulation::addRunningTime(std::chrono::steady_clock::time_point since) {
+    running_time += std::chrono::steady_clock::now() - since;
 }
 
+bool Simulation::overTimeBudget(std::chrono::steady_clock::time_point phase_start) {
+    if (time_budget > 0 &&
+        running_time + (std::chrono::steady_clock::now() - phase_start) >= std::chrono::seconds(time_budget))
+        cancel();
+    return cancelled;
+}
 
-bool
-Simulation::runSimulation() {
-    vector<string> travel_files;
-    int num_of_errors = 0;
-    bool no_errors_detected;
-    vector<pair<int, string>> errs_in_ctor;
-    std::unique_ptr<AbstractAlgorithm> algo = algo_name_and_ctor.second();
+void Simulation::startTravel() {
+    auto phase_start = std::chrono::steady_clock::now();
+    // The simulation's own ship and route, the ports containers are still shared until the ship arrives to them
+    ship = travel_template->ship;
+    travel = travel_template->route;
+    algo = algo_name_and_ctor.second();
+    if (parsed_input) { // Negotiated at the algorithm's registration, so it is a ParsedInputAlgorithm
+        algo_input = std::move(travel_template);
+        analyzeErrCode(static_cast<ParsedInputAlgorithm &>(*algo).setParsedInput(*algo_input));
+    }
+    travel_template.reset();
 
-    cout << "\nExecuting Travel " << curr_travel_name << "..." << endl;
+    LOG_MESSAGE(Logger::getInstance(), LogLevel::Info, "\nExecuting Travel " + curr_travel_name + "...");
     //SIMULATION
     analyzeErrCode(algo->readShipPlan(plan_path));
     analyzeErrCode(algo->readShipRoute(route_path));
     analyzeErrCode(algo->setWeightBalanceCalculator(calc));
 
-    no_errors_detected = executeTravel(algo_name_and_ctor.first, *algo, calc, num_of_errors);
+    //Creating instructions directory for the algorithm, unless it sends its instructions and they aren't written
+    instruction_file_path = output_dir_path;
+    if (instruction_files || !instructions_channel) {
+        instruction_file_path = createInstructionDir(output_dir_path, algo_name_and_ctor.first, curr_travel_name);
+        if (instruction_file_path.empty()) {
+            LOG_MESSAGE(Logger::getInstance(), LogLevel::Error,
+                        "ERROR: Failed creating instruction files directory; creates everything inside the output folder.");
+            instruction_file_path = output_dir_path;
+        }
+    }
+    addRunningTime(phase_start);
+}
+
+bool Simulation::executeNextPort() {
+    auto phase_start = std::chrono::steady_clock::now();
+    // Checked by its own running time, since in lockstep the other simulations of the task run in between
+    if (overTimeBudget(phase_start) || !travel.moveToNextPort(ship)) {
+        return false; // The travel is over
+    }
+    curr_port_name = travel.getCurrentPort().getName();
+    curr_port_index++;
+    string instruction_file =
+            instruction_file_path + std::filesystem::path::preferred_separator + curr_port_name + "_" +
+            to_string(travel.getNumOfVisitsInPort(curr_port_name)) + ".crane_instructions";
+    InstructionsBuffer instructions(instruction_files);
+    analyzeErrCode(getPortInstructions(*algo, travel.getCurrentPortPath(), instruction_file, instructions));
+    if (overTimeBudget(phase_start)) {
+        return false; // Ran out of time while the algorithm was working, the port is not validated
+    }
+    iterateInstructions(calc, instructions, num_of_operations);
+    checkMissedContainers(travel.getCurrentPort().getName());
+    portCompleted();
+    addRunningTime(phase_start);
+    return true;
+}
 
-    return no_errors_detected; // true if no errors were detected.
+void Simulation::portCompleted() {
+    int ports = ++completed_ports;
+    if (progress_listener)
+        progress_listener(ports, curr_port_name);
 }
 
-bool Simulation::validateInstruction(const vector<string> &instructions) { // Check if the text line is legal
-    if (instructions.size() == 5) { // May be 'L' 'U' or 'R' instruction
-        if (instructions[0] != "L" && instructions[0] != "U" && instructions[0] != "R")
-            return false; //Invalid instruction
-        if (!isNumber(instructions[2]) || !isNumber(instructions[3]) || !isNumber(instructions[4])) {
-            return false;
+void Simulation::executePortsPipelined() {
+    auto phase_start = std::chrono::steady_clock::now();
+    // Prepare the files of all of the ports, so the algorithm doesn't need the travel's state
+    vector<string> ports_names = travel.getLeftPortsNames(0);
+    vector<pair<string, string>> ports_files; // (containers file, instructions file) of each port, by route order
+    map<string, int> visits;
+    for (int port_num = 0; port_num < (int) ports_names.size(); ++port_num) {
+        ports_files.emplace_back(travel.getPortPathAt(port_num),
+                                 instruction_file_path + std::filesystem::path::preferred_separator +
+                                 ports_names[port_num] + "_" + to_string(++visits[ports_names[port_num]]) +
+                                 ".crane_instructions");
+    }
+    // Each port's instructions are filled by the algorithm's stage before its code is pushed
+    vector<InstructionsBuffer> ports_instructions(ports_files.size(), InstructionsBuffer(instruction_files));
+    BoundedQueue<int> algo_err_codes(PIPELINE_DEPTH);
+    AbstractAlgorithm &algo_ref = *algo;
+    // The algorithm's stage is the first job, so if no other worker is free it's run before the validation
+    vector<std::function<void()>> stages;
+    stages.emplace_back([this, &algo_ref, &ports_files, &ports_instructions, &algo_err_codes] {
+        // A code is given for every port, so the validation never waits for a port that won't come
+        for (int port_num = 0; port_num < (int) ports_files.size(); ++port_num) {
+            algo_err_codes.push(cancelled ? 0 : getPortInstructions(algo_ref, ports_files[port_num].first,
+                                                                    ports_files[port_num].second,
+                                                                    ports_instructions[port_num]));
         }
-    } else if (instructions.size() == 8) {
-        if (instructions[0] != "M") // check if it's really Move instruction
-            return false;
-        if (!isNumber(instructions[2]) || !isNumber(instructions[3]) || !isNumber(instructions[4]) ||
-            !isNumber(instructions[5]) || !isNumber(instructions[6]) || !isNumber(instructions[7])) {
-            return false;
+    });
+    stages.emplace_back([this, &ports_files, &ports_instructions, &algo_err_codes] {
+        int port_num = 0, popped_codes = 0;
+        while (!cancelled && travel.moveToNextPort(ship)) { // For each port in travel
+            curr_port_name = travel.getCurrentPort().getName();
+            curr_port_index++;
+            analyzeErrCode(algo_err_codes.pop()); // Waits until the algorithm is done with this port
+            popped_codes++;
+            if (cancelled)
+                break;
+            iterateInstructions(calc, ports_instructions[port_num], num_of_operations);
+            ports_instructions[port_num++] = InstructionsBuffer(); // Validated, its memory isn't needed anymore
+            checkMissedContainers(curr_port_name);
+            portCompleted();
+        }
+        // If it ran out of time, let the algorithm's stage go through the ports that are left. It waits for this stage
+        // only once a code was taken, so a stage that starts after the simulation was given up doesn't get stuck
+        for (; popped_codes > 0 && popped_codes < (int) ports_files.size(); ++popped_codes) {
+            algo_err_codes.pop();
+        }
+    });
+    if (thread_pool) {
+        for (auto &stage : stages) {
+            stage = [this, stage] { runStage(stage); };
+        }
+        thread_pool->runJobs(stages, PIPELINE_STAGE_COST);
+    } else {
+        for (auto &stage : stages) {
+            stage();
         }
-        // instructions[1] will be validated later.
-    } else { // Wrong number of aguments for the instruction
-        return false;
     }
-    return true;
+    addRunningTime(phase_start);
+}
+
+void Simulation::runStage(const std::function<void()> &stage) {
+    auto worker = ThreadPool::getCurrentWorker(); // Always a worker of the simulation's pool
+    if (worker) {
+        std::lock_guard<std::mutex> lock(stage_workers_mutex);
+        stage_workers.push_back(worker);
+    }
+    stage();
+    if (worker) {
+        // Under the lock, so the worker isn't given up once it may have gone on to another task
+        std::lock_guard<std::mutex> lock(stage_workers_mutex);
+        stage_workers.erase(std::find(stage_workers.begin(), stage_workers.end(), worker));
+    }
+}
+
+void Simulation::reportTimeout() {
+    int ports = completed_ports;
+    insertResult("-1", true);
+    insertError(ErrorKind::Text, timeoutMessage(curr_travel_name, time_budget,
+                                                ports > 0 ? (*ports_names)[ports - 1] : "", ports,
+                                                (int) ports_names->size()));
+}
+
+bool Simulation::abandon() {
+    cancel();
+    int ports = completed_ports;
+    result_cell->timeout_error = timeoutMessage(curr_travel_name, time_budget,
+                                                ports > 0 ? (*ports_names)[ports - 1] : "", ports,
+                                                (int) ports_names->size());
+    auto state = ResultCell::Empty;
+    return result_cell->state.compare_exchange_strong(state, ResultCell::Abandoned, std::memory_order_release);
+}
+
+void Simulation::abandonStageWorkers() {
+    std::lock_guard<std::mutex> lock(stage_workers_mutex);
+    for (auto &worker : stage_workers) {
+        thread_pool->abandonWorker(worker);
+    }
+}
+
+string Simulation::timeoutMessage(const string &travel_name, int time_budget, const string &last_port,
+                                  int completed_ports, int num_of_ports) {
+    return "@ Travel: " + travel_name + "- the simulation ran out of its time budget (" + to_string(time_budget) +
+           " seconds), " + (completed_ports > 0 ? "the last completed port was " + last_port : "no port was completed") +
+           " (" + to_string(completed_ports) + " out of " + to_string(num_of_ports) + " ports).";
+}
+
+string Simulation::formatError(const ErrorRecord &err, const string &travel_name, const vector<string> &ports_names) {
+    switch (err.kind) {
+        case ErrorKind::Text:
+            return err.subject;
+        case ErrorKind::AlgorithmReported:
+            return "@ Algorithm reported in travel " + travel_name + ": " + errCodes.at(err.value);
+        case ErrorKind::MissedDestination:
+            return "@ Travel: " + travel_name +
+                   "- There are some containers that were not unloaded at their destination port: " + err.subject;
+        default:
+            break;
+    }
+    const ErrorFormat &format = errFormats.at(err.kind);
+    string msg = "@ Travel: " + travel_name + "- Port: ";
+    if (err.port_index >= 0 && err.port_index < (int) ports_names.size())
+        msg += ports_names[err.port_index];
+    msg += format.before;
+    if (format.field == ErrorFormat::Subject)
+        msg += err.subject;
+    else if (format.field == ErrorFormat::Value)
+        msg += to_string(err.value);
+    return msg + format.after;
+}
+
+bool Simulation::finishTravel() {
+    auto phase_start = std::chrono::steady_clock::now();
+    algo.reset();
+    algo_input.reset();
+    if (!instruction_files && instruction_file_path != output_dir_path) {
+        std::error_code err;
+        std::filesystem::remove(instruction_file_path, err); // Its files were removed once read, so it's empty
+    }
+    bool no_errors_detected = false;
+    if (cancelled) {
+        reportTimeout();
+    } else {
+        no_errors_detected = !this->err_in_travel;
+        // Check if there was an error by the algorithm. if there was, number of operation is '-1'.
+        if (this->err_in_travel) {
+            insertResult("-1", true);
+        } else {
+            insertResult(to_string(num_of_operations), false);
+        }
+    }
+    addRunningTime(phase_start);
+    result_cell->duration = (long) std::chrono::duration_cast<std::chrono::microseconds>(running_time).count();
+    // Hands the cell to the simulator, unless the task was given up meanwhile
+    auto state = ResultCell::Empty;
+    result_cell->state.compare_exchange_strong(state, ResultCell::Done, std::memory_order_release);
+    return no_errors_detected;
+}
+
+bool
+Simulation::runSimulation() {
+    startTravel();
+    if (pipelined_ports) {
+        executePortsPipelined();
+    } else {
+        while (executeNextPort()) {} // For each port in travel
+    }
+    return finishTravel(); // true if no errors were detected.
 }
 
 void Simulation::reportInvalidContainer(Container *cont) {
     // Containers ID is validated earlier.
     if (cont->getWeight() <= 0) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Trying to load a container with illegal weight: " +
-                               to_string(cont->getWeight()));
+        insertError(ErrorKind::LoadIllegalWeight, "", cont->getWeight());
     } else if (!Port::validateName(cont->getDestPort())) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Trying to load a container with illegal destination port: " +
-                               cont->getDestPort());
+        insertError(ErrorKind::LoadIllegalDestination, cont->getDestPort());
     } else if (ship.isContOnShip(cont->getID())) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Trying to load a container which it's ID already exists on the ship: " +
-                               cont->getID());
+        insertError(ErrorKind::LoadIdOnShip, cont->getID());
     }
     // DEBUG:Should never reach here.
-    Simulator::insertError(num_of_algo, num_of_travel,
-                           "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                           "- Trying to load an invalid container.");
+    insertError(ErrorKind::LoadInvalidContainer);
 }
 
 bool
@@ -147,29 +358,21 @@ Simulation::validateLoadOp(Port &curr_port, WeightBalanceCalculator &calc,
     Spot *pos, *pos_below;
     // Spot validation
     if (!ship.spotInRange(x, y) || floor_num < 0 || floor_num >= ship.getNumOfDecks()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container in Out-Of-Range position.");
+        insertError(ErrorKind::LoadOutOfRange);
         return false;
     }
     if (ship.isFull()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container in a full ship.");
+        insertError(ErrorKind::LoadFullShip);
         return false; // Ship is full!
     }
     pos = &(ship.getSpotAt(floor_num, x, y));
     if (!pos->getAvailable() || pos->getContainer() != nullptr) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container in an unavailable spot.");
+        insertError(ErrorKind::LoadUnavailableSpot);
         return false;
     }
     //Container validation
     if (cont == nullptr) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Trying to load an unavailable container.");
+        insertError(ErrorKind::LoadUnavailableContainer);
         return false; // Given id_cont is not in the waiting list
     }
     if (!cont->isValid()) { // Check if the container is not valid
@@ -177,45 +380,33 @@ Simulation::validateLoadOp(Port &curr_port, WeightBalanceCalculator &calc,
         return false;
     } else { // Container is valid, now check the duplication case
         if (cont->getSpotInFloor() != nullptr && curr_port.getNumOfDuplicates(cont->getID()) > 0) {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Trying to load a container with a duplicated ID: " + cont->getID());
+            insertError(ErrorKind::LoadDuplicatedId, cont->getID());
             curr_port.decreaseDuplicateId(cont->getID()); // Update that a duplicated ID container got treated
             return false;
         }
     }
     if (cont->getSpotInFloor() != nullptr) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Trying to load a container that is already on the ship.");
+        insertError(ErrorKind::LoadAlreadyOnShip);
         return false;
     }
     if (cont->getDestPort() == this->curr_port_name) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container that its destination is the current port.");
+        insertError(ErrorKind::LoadDestIsCurrentPort);
         return false;
     }
     if (!travel.isInRoute(cont->getDestPort())) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container that its destination is not within the remaining route.");
+        insertError(ErrorKind::LoadDestNotInRoute);
         return false;
     }
     // Balance validation
     if (calc.tryOperation('L', cont->getWeight(), x, y) != WeightBalanceCalculator::APPROVED) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Load a container that un-balances the ship.");
+        insertError(ErrorKind::LoadUnbalances);
         return false;
     }
     if (floor_num != 0) {
         pos_below = &(ship.getSpotAt(floor_num - 1, x, y));
         if (pos_below->getAvailable() &&
             pos_below->getContainer() == nullptr) { // check if there is no container at the floor below
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Load a container in a spot that's above an empty spot.");
+            insertError(ErrorKind::LoadAboveEmptySpot);
             return false;
         }
     }
@@ -228,41 +419,28 @@ Simulation::validateUnloadOp(WeightBalanceCalculator &calc, int floor_num,
     Spot *pos, *pos_above;
     // Spot validation
     if (!ship.spotInRange(x, y) || floor_num < 0 || floor_num >= ship.getNumOfDecks()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Unload a container with ID: " + cont_id + "- from Out-Of-Range position.");
+        insertError(ErrorKind::UnloadOutOfRange, cont_id);
         return false;
     }
     pos = &(ship.getSpotAt(floor_num, x, y));
     if (!pos->getAvailable() || pos->getContainer() == nullptr) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Unload a container with ID: " + cont_id +
-                               "- from an unavailable or empty spot.");
+        insertError(ErrorKind::UnloadEmptySpot, cont_id);
         return false;
     }
     Container *cont = pos->getContainer();
     //Container validation
     if (cont_id != cont->getID()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Unload a container with ID: " + cont_id + "- that isn't in the given spot.");
+        insertError(ErrorKind::UnloadWrongSpot, cont_id);
         return false;
     }
     // Balance validation
     if (calc.tryOperation('U', cont->getWeight(), x, y) != WeightBalanceCalculator::APPROVED) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Unload a container with ID: " + cont_id +
-                               "- from from the ship unbalance it.");
+        insertError(ErrorKind::UnloadUnbalances, cont_id);
         return false;
     } else if (floor_num != ship.getNumOfDecks() - 1) {
         pos_above = &(ship.getSpotAt(floor_num + 1, x, y));
         if (pos_above->getContainer() != nullptr) { // check if there is a container at the floor above
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Unload a container with ID: " + cont_id +
-                                   "- while there's a container above it.");
+            insertError(ErrorKind::UnloadContainerAbove, cont_id);
             return false;
         }
     }
@@ -276,60 +454,43 @@ bool Simulation::validateMoveOp(WeightBalanceCalculator &calc,
     // Spots validation
     if (!ship.spotInRange(source_x, source_y) || source_floor_num < 0 || source_floor_num >= ship.getNumOfDecks() ||
         !ship.spotInRange(dest_x, dest_y) || dest_floor_num < 0 || dest_floor_num >= ship.getNumOfDecks()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Move a container with ID: " + cont_id + "- using Out-Of-Range position.");
+        insertError(ErrorKind::MoveOutOfRange, cont_id);
         return false;
     }
     if ((source_x == dest_x) && (source_y == dest_y) && (source_floor_num != dest_floor_num)) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Move a container with ID: " + cont_id +
-                               "- to a spot with the same X,Y but at different floor.");
+        insertError(ErrorKind::MoveSameXY, cont_id);
         return false;
     }
     source_pos = &(ship.getSpotAt(source_floor_num, source_x, source_y));
     dest_pos = &(ship.getSpotAt(dest_floor_num, dest_x, dest_y));
     if (!source_pos->getAvailable() || source_pos->getContainer() == nullptr ||
         !dest_pos->getAvailable() || dest_pos->getContainer() != nullptr) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Move a container with ID: " + cont_id + "- using unavailable spot.");
+        insertError(ErrorKind::MoveUnavailableSpot, cont_id);
         return false;
     }
     Container *cont = source_pos->getContainer();
     //Container validation
     if (cont_id != cont->getID()) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Move a container with ID: " + cont_id + "- that isn't in the given spot.");
+        insertError(ErrorKind::MoveWrongSpot, cont_id);
         return false;
     }
     // Balance validation
     if (calc.tryOperation('U', cont->getWeight(), source_x, source_y) != WeightBalanceCalculator::APPROVED
         || calc.tryOperation('L', cont->getWeight(), dest_x, dest_y) != WeightBalanceCalculator::APPROVED) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Move a container with ID: " + cont_id + "- cause the ship to unbalance.");
+        insertError(ErrorKind::MoveUnbalances, cont_id);
         return false;
     } else {
         if (source_floor_num != ship.getNumOfDecks() - 1) {
             pos_above = &(ship.getSpotAt(source_floor_num + 1, source_x, source_y));
             if (pos_above->getContainer() != nullptr) { // check if there is a container at the floor above
-                Simulator::insertError(num_of_algo, num_of_travel,
-                                       "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                       "- Move a container with ID: " + cont_id +
-                                       "- while there's a container above it.");
+                insertError(ErrorKind::MoveContainerAbove, cont_id);
                 return false;
             }
             if (dest_floor_num != 0) {
                 pos_below = &(ship.getSpotAt(dest_floor_num - 1, dest_x, dest_y));
                 if (pos_below->getAvailable() &&
                     pos_below->getContainer() == nullptr) { // check if there is no container at the floor below
-                    Simulator::insertError(num_of_algo, num_of_travel,
-                                           "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                           "- Move a container with ID: " + cont_id +
-                                           "- to a spot that's above an empty spot.");
+                    insertError(ErrorKind::MoveAboveEmptySpot, cont_id);
                     return false;
                 }
             }
@@ -352,16 +513,11 @@ Simulation::validateRejectOp(Route &travel,
     cont = travel.getCurrentPort().getWaitingContainerByID(cont_id, false); // get a container from the port
     //Container validation
     if (cont == nullptr && !ship.isContOnShip(cont_id)) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Reject a container with ID: " + cont_id +
-                               "- that wasn't provided by the port.");
+        insertError(ErrorKind::RejectNotInPort, cont_id);
         return false; // Given id_cont is not in the waiting list
     }
     if (cont->getSpotInFloor() != nullptr) { // The container was loaded though reported rejected.
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Reject a container with ID: " + cont_id + "- that was already loaded.");
+        insertError(ErrorKind::RejectAlreadyLoaded, cont_id);
         return false;
     }
     if (travel.getCurrentPort().getNumOfDuplicates(cont_id) > 0) {
@@ -371,10 +527,7 @@ Simulation::validateRejectOp(Route &travel,
     } else if (cont->isValid() && travel.isInRoute(cont->getDestPort()) && this->curr_port_name !=
                                                                            cont->getDestPort()) { // Check if the container's weight and destination are valid.
         if (ship.getNumOfFreeSpots() > 0) {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Reject a container with ID: " + cont_id +
-                                   "- although it can be loaded correctly.");
+            insertError(ErrorKind::RejectLoadable, cont_id);
             return false;
         }
         has_potential_to_be_loaded = true;
@@ -391,44 +544,30 @@ void removeUnloadedContainer(map<string, Container *> &unloaded_containers, Cont
     }
 }
 
-int getFarthestDestOfContainerIndex(vector<Container> &conts) {
-    int max_ind = -1;
-    for (int i = 0; i < (int) conts.size(); ++i) {
-        if (conts[i].getSpotInFloor() !=
-            nullptr) { // find a container that was loaded on the ship, note that the container must be valid.
-            max_ind = i; // i is always being raised
-        }
+DestinationOrder::DestinationOrder(const vector<Container> &containers, const Route &route) {
+    std::unordered_map<string, int> ranks = route.getDestinationsRanks();
+    vector<int> ranked(containers.size());
+    for (int i = 0; i < (int) containers.size(); ++i)
+        ranked[i] = Route::getDestinationRank(ranks, containers[i].getDestPort());
+    // Sorts the indexes as Route::sortContainersByDestination sorts the containers, so equivalent containers get the
+    // same positions
+    vector<int> order(containers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ranked](int c1, int c2) { return ranked[c1] < ranked[c2]; });
+    for (int pos = 0; pos < (int) order.size(); ++pos) {
+        const Container &cont = containers[order[pos]];
+        last_position[cont.getDestPort()] = pos;
+        if (cont.getSpotInFloor() != nullptr) // The container was loaded on the ship, note that it must be valid
+            farthest_loaded = pos;
     }
-    return max_ind;
 }
 
-/*
- * Returns the maximal index of container in the vector, that it's destination is the given destination.
- */
-int getContainerIndexByDestination(vector<Container> &containers, const string &port_name) {
-    int index = 0;
-    for (int i = 0; i < (int) containers.size(); ++i) {
-        if (containers[i].getDestPort() == port_name)
-            index = i;
-    }
-    return index;
-}
-
-/**
- * Checks if the given container has destination that isn't closer than any container that was loaded on the ship from the current port.
- */
-bool checkSortedContainers(vector<Container> &conts, Route &travel, const string &cont_id) {
-    int farthest_port_num;
-    vector<Container> temp_containers = conts;
-    travel.sortContainersByDestination(temp_containers);
-    farthest_port_num = getFarthestDestOfContainerIndex(
-            temp_containers); // get the maximal index of a container that was load to the ship.
-    if (getContainerIndexByDestination(temp_containers,
-                                       Port::getContainerByIDFrom(temp_containers, cont_id)->getDestPort()) <
-        farthest_port_num) {
-        return false;
-    }
-    return true;
+bool Simulation::checkSortedContainers(Port &curr_port, const string &cont_id) {
+    if (!port_order)
+        port_order.emplace(std::as_const(curr_port).getWaitingContainers(), travel);
+    // The port has a single valid container with this ID
+    const string dest = curr_port.getWaitingContainerByID(cont_id, true)->getDestPort();
+    return port_order->last_position.at(dest) >= port_order->farthest_loaded;
 }
 
 // Validates all the containers that were left at the port at the end of travel.
@@ -440,108 +579,106 @@ void Simulation::checkRemainingContainers(map<string, Container *> &unloaded_con
             if (rejected_containers.find(entry.first) !=
                 rejected_containers.end()) { // check if the container was also rejected. if so, the container had a potential to be loaded on the ship.
                 if (!ship.isFull()) {
-                    Simulator::insertError(num_of_algo, num_of_travel,
-                                           "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                           "- Rejected a container with ID: " + entry.second->getID() +
-                                           "- although it can be loaded correctly.");
+                    insertError(ErrorKind::RejectedLoadable, entry.second->getID());
                     this->err_in_travel = true;
-                } else if (!checkSortedContainers(curr_port.getWaitingContainers(), travel,
-                                                  entry.first)) { // check if the container was rejected mistakenly
-                    Simulator::insertError(num_of_algo, num_of_travel,
-                                           "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                           "- Rejected a container with ID: " + entry.second->getID() +
-                                           "- while another container was loaded and it's destination port is further.");
+                } else if (!checkSortedContainers(curr_port, entry.first)) { // check if the container was rejected mistakenly
+                    insertError(ErrorKind::RejectedFartherLoaded, entry.second->getID());
                     this->err_in_travel = true;
                 }
             } // <<< it is not possible to reach the else statement of that if
         } else { // In case the container was from the ship
             if (entry.second->getDestPort() != curr_port.getName()) { // The wrong container got unloaded!
-                Simulator::insertError(num_of_algo, num_of_travel,
-                                       "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                       "- A container with ID: " + entry.second->getID() +
-                                       "- was left in a port that's different from container's destination.");
+                insertError(ErrorKind::LeftAtWrongPort, entry.second->getID());
                 this->err_in_travel = true;
             }
         }
     }
 }
 
-void Simulation::checkPortContainers(vector<string> &ignored_containers, Port &curr_port) {
+UntreatedContainers::UntreatedContainers(vector<string> port_ids) : ids(std::move(port_ids)) {
+    untreated.reserve(ids.size());
+    for (auto &id : ids)
+        untreated[id]++;
+}
+
+void UntreatedContainers::treat(const string &id) {
+    auto found = untreated.find(id);
+    if (found != untreated.end() && found->second > 0)
+        found->second--;
+}
+
+vector<string> UntreatedContainers::list() const {
+    // The treated containers of an ID are its first ones, skip them
+    std::unordered_map<string, int> to_skip;
+    for (auto &id : ids)
+        to_skip[id]++;
+    for (auto &entry : untreated)
+        to_skip[entry.first] -= entry.second;
+    vector<string> left;
+    for (auto &id : ids) {
+        int &skip = to_skip[id];
+        if (skip > 0)
+            skip--;
+        else
+            left.push_back(id);
+    }
+    return left;
+}
+
+void Simulation::checkPortContainers(const UntreatedContainers &ignored_containers, Port &curr_port) {
     Container *ignored_cont = nullptr;
-    for (auto &container_id : ignored_containers) { // for each container that came from this port that was not treated.
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- A container with ID: " + container_id +
-                               "- was left at the port without getting an instruction.");
+    for (auto &container_id : ignored_containers.list()) { // for each container that came from this port that was not treated.
+        insertError(ErrorKind::LeftWithoutInstruction, container_id);
         //Check sorted containers
         ignored_cont = curr_port.getWaitingContainerByID(container_id, true); // get valid container from the port
         if (ignored_cont == nullptr) // didn't find valid container
             continue;
         if (travel.isInRoute(ignored_cont->getDestPort()) && this->curr_port_name != ignored_cont->getDestPort() &&
-            !checkSortedContainers(curr_port.getWaitingContainers(), travel, container_id)) {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- A container with ID: " + container_id +
-                                   "- was left in port while another container was loaded and it's destination port is further.");
+            !checkSortedContainers(curr_port, container_id)) {
+            insertError(ErrorKind::LeftFartherLoaded, container_id);
         }
         this->err_in_travel = true;
     }
     for (auto &cont : curr_port.getDuplicateIdOnPort()) { // for each duplicated container that came from this port that was not treated.
         if (cont.second > 0) {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- A container with ID: " + cont.first +
-                                   "- did not get rejected though it has duplicated ID.");
+            insertError(ErrorKind::DuplicateNotRejected, cont.first);
             this->err_in_travel = true;
         }
     }
 }
 
 bool
-Simulation::validateCargoInstruction(vector<string> &instruction, vector<string> &ignoredContainers,
-                                     Container **cont_to_load, Port &current_port,
-                                     AbstractAlgorithm::Action &command,
-                                     const map<string, Container *> &unloaded_containers) {
-    if (!validateInstruction(instruction)) {
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                               "- Invalid instruction detected.");
-        this->err_in_travel = true;
-        return false;
-    }
+Simulation::validateCargoInstruction(const CraneInstruction &instruction, const string &cont_id,
+                                     UntreatedContainers &ignoredContainers, Container **cont_to_load,
+                                     Port &current_port, const map<string, Container *> &unloaded_containers) {
     // Check if the container ID is from the port and delete it.
-    auto position = std::find(ignoredContainers.begin(), ignoredContainers.end(), instruction[ContainerID]);
-    if (position != ignoredContainers.end()) // if ID was found
-        ignoredContainers.erase(position);
-
-    command = actionDic.at(instruction[Command]);
-    if (command != AbstractAlgorithm::Action::REJECT) {
-        if (!Container::validateID(instruction[ContainerID])) {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Instruction with invalid container ID detected.");
+    ignoredContainers.treat(cont_id);
+
+    if (instruction.action != AbstractAlgorithm::Action::REJECT) {
+        if (!Container::validateID(cont_id)) {
+            insertError(ErrorKind::InvalidContainerId);
             this->err_in_travel = true;
             return false; // Bad id for container
         }
-        *cont_to_load = (unloaded_containers.find(instruction[ContainerID]) != unloaded_containers.end() &&
-                         unloaded_containers.at(instruction[ContainerID])->getDestPort() != this->curr_port_name)
-                        ? unloaded_containers.at(instruction[ContainerID]) : nullptr;
+        auto unloaded = unloaded_containers.find(cont_id);
+        *cont_to_load = (unloaded != unloaded_containers.end() &&
+                         unloaded->second->getDestPort() != this->curr_port_name) ? unloaded->second : nullptr;
         if (*cont_to_load ==
             nullptr) {
-            *cont_to_load = current_port.getWaitingContainerByID(instruction[ContainerID],
-                                                                 false); //Get the container from the port
+            *cont_to_load = current_port.getWaitingContainerByID(cont_id, false); //Get the container from the port
         }
     }
     return true;
 }
 
 void
-Simulation::implementInstruction(vector<string> &instruction, AbstractAlgorithm::Action command, int &num_of_operations,
-                                 int num_of_algo, Port &current_port, WeightBalanceCalculator &calc,
+Simulation::implementInstruction(const CraneInstruction &instruction, const string &cont_id, int &num_of_operations,
+                                 Port &current_port, WeightBalanceCalculator &calc,
                                  map<string, Container *> &rejected_containers,
-                                 map<string, Container *> &unloaded_containers,
-                                 int floor_num, int x, int y, Container *cont_to_load) {
-    switch (command) {
+                                 map<string, Container *> &unloaded_containers, Container *cont_to_load) {
+    int floor_num = instruction.floor, x = instruction.x, y = instruction.y;
+    instruction_position = {floor_num, x, y}; // Kept in the errors that are found while implementing it
+    switch (instruction.action) {
         case AbstractAlgorithm::Action::LOAD: {
             if (!validateLoadOp(current_port, calc, floor_num, x, y, cont_to_load)) {
                 this->err_in_travel = true;
@@ -554,7 +691,7 @@ Simulation::implementInstruction(vector<string> &instruction, AbstractAlgorithm:
             break;
         }
         case AbstractAlgorithm::Action::UNLOAD: {
-            if (!validateUnloadOp(calc, floor_num, x, y, instruction[ContainerID])) {
+            if (!validateUnloadOp(calc, floor_num, x, y, cont_id)) {
                 this->err_in_travel = true;
                 break;
             }
@@ -567,61 +704,78 @@ Simulation::implementInstruction(vector<string> &instruction, AbstractAlgorithm:
             break;
         }
         case AbstractAlgorithm::Action::MOVE: {
-            if (!validateMoveOp(calc, floor_num, x, y, string2int(instruction[DestFloorNum]),
-                                string2int(instruction[DestX]), string2int(instruction[DestY]),
-                                instruction[ContainerID])) {
+            if (!validateMoveOp(calc, floor_num, x, y, instruction.dest_floor, instruction.dest_x, instruction.dest_y,
+                                cont_id)) {
                 this->err_in_travel = true;
                 break;
             }
             // Move container on the ship
-            ship.moveContainer(floor_num, x, y, string2int(instruction[DestFloorNum]), string2int(instruction[DestX]),
-                               string2int(instruction[DestY]));
+            ship.moveContainer(floor_num, x, y, instruction.dest_floor, instruction.dest_x, instruction.dest_y);
             num_of_operations += 3;
             break;
         }
         case AbstractAlgorithm::Action::REJECT: {
             bool has_potential_to_be_loaded = false;
-            if (!validateRejectOp(travel, floor_num, x, y, instruction[ContainerID],
-                                  has_potential_to_be_loaded)) {
+            if (!validateRejectOp(travel, floor_num, x, y, cont_id, has_potential_to_be_loaded)) {
                 this->err_in_travel = true;
                 break;
             }
-            Container *r_cont = current_port.getWaitingContainerByID(instruction[ContainerID], false);
-            rejected_containers.insert({instruction[ContainerID], r_cont});
+            Container *r_cont = current_port.getWaitingContainerByID(cont_id, false);
+            rejected_containers.insert({cont_id, r_cont});
             if (has_potential_to_be_loaded)
-                unloaded_containers.insert({instruction[ContainerID],
+                unloaded_containers.insert({cont_id,
                                             r_cont}); // add to unloaded_containers so that we will later check if it was rejected correctly.
             break;
         }
         default: {
-            Simulator::insertError(num_of_algo, num_of_travel,
-                                   "@ Travel: " + this->curr_travel_name + "- Port: " + this->curr_port_name +
-                                   "- Invalid instruction detected.");
+            insertError(ErrorKind::InvalidInstruction);
             this->err_in_travel = true;
         }
     }
 }
 
+int Simulation::getPortInstructions(AbstractAlgorithm &algorithm, const string &cargo_file,
+                                    const string &instruction_file, InstructionsBuffer &instructions) {
+    int err_code;
+    if (instructions_channel) {
+        // Negotiated at the algorithm's registration, so it is an InstructionsChannelAlgorithm
+        err_code = static_cast<InstructionsChannelAlgorithm &>(algorithm).sendInstructionsForCargo(cargo_file,
+                                                                                                  instructions);
+        if (instruction_files)
+            instructions.writeFile(instruction_file);
+    } else {
+        err_code = algorithm.getInstructionsForCargo(cargo_file, instruction_file);
+        instructions.readFile(instruction_file);
+        if (!instruction_files)
+            FileHandler::deleteFile(instruction_file);
+    }
+    return err_code;
+}
+
 void
-Simulation::iterateInstructions(WeightBalanceCalculator &calc, const string &instruction_file, int &num_of_operations,
-                                int num_of_algo) {
-    FileHandler file(instruction_file);
-    vector<string> instruction;
+Simulation::iterateInstructions(WeightBalanceCalculator &calc, const InstructionsBuffer &instructions,
+                                int &num_of_operations) {
+    CraneInstruction instruction{};
+    string cont_id; // The ID of the instruction's container, its buffer is kept for the next instructions
     Container *cont_to_load = nullptr;
     Port &current_port = travel.getCurrentPort();
     map<string, Container *> rejected_containers; // Contains all containers that were rejected correctly.
     map<string, Container *> unloaded_containers; // Contains all containers that were rejected correctly and had potential to be loaded, but ship was full + all containers that were unloaded.
-    vector<string> ignored_containers = current_port.getContainersIDFromPort();
-    AbstractAlgorithm::Action command;
-    while (file.getNextLineAsTokens(instruction)) {
-        if (!validateCargoInstruction(instruction, ignored_containers, &cont_to_load, current_port,
-                                      command,
+    UntreatedContainers ignored_containers(current_port.getContainersIDFromPort());
+    port_order.reset(); // Computed for this port once its instructions were implemented
+    for (int index = 0; index < instructions.size(); ++index) {
+        if (!instructions.getInstruction(index, instruction)) {
+            insertError(ErrorKind::InvalidInstruction);
+            this->err_in_travel = true;
+            continue;
+        }
+        cont_id.assign(instruction.container_id);
+        if (!validateCargoInstruction(instruction, cont_id, ignored_containers, &cont_to_load, current_port,
                                       unloaded_containers))
             continue;
-        implementInstruction(instruction, command, num_of_operations, num_of_algo, current_port, calc,
-                             rejected_containers, unloaded_containers,
-                             string2int(instruction[FloorNum]), string2int(instruction[X]), string2int(instruction[Y]),
-                             cont_to_load);
+        implementInstruction(instruction, cont_id, num_of_operations, current_port, calc,
+                             rejected_containers, unloaded_containers, cont_to_load);
+        instruction_position = {-1, -1, -1};
     }
     checkRemainingContainers(unloaded_containers, rejected_containers, current_port);
     checkPortContainers(ignored_containers, current_port);
@@ -629,9 +783,7 @@ Simulation::iterateInstructions(WeightBalanceCalculator &calc, const string &ins
 
 void Simulation::checkMissedContainers(const string &port_name) {
     if ((int) ship.getContainersForDest(port_name).size() > 0) {
-        Simulator::insertError(num_of_algo, num_of_travel, "@ Travel: " + this->curr_travel_name +
-                                                           "- There are some containers that were not unloaded at their destination port: " +
-                                                           port_name);
+        insertError(ErrorKind::MissedDestination, port_name);
         this->err_in_travel = true;
     }
 }
@@ -640,7 +792,6 @@ void Simulation::analyzeErrCode(int err_code) {
     vector<unsigned int> one_indexes = getOneIndexes(err_code);
     for (const unsigned int index : one_indexes) {
         if (index > 18) return; // No error code is defined for indexes above 18.
-        Simulator::insertError(num_of_algo, num_of_travel,
-                               "@ Algorithm reported in travel " + curr_travel_name + ": " + errCodes.at(index));
+        insertError(ErrorKind::AlgorithmReported, "", (int) index);
     }
 }
\ No newline at end of file
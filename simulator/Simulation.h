@@ -4,14 +4,32 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <unordered_map>
 #include <search.h>
 #include <filesystem>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <numeric>
+#include <limits>
+#include <mutex>
 #include "../common/ShipPlan.h"
 #include "../common/Route.h"
 #include "../interfaces/AbstractAlgorithm.h"
 #include "../common/Utils.h"
+#include "../common/Logger.h"
 #include "../interfaces/WeightBalanceCalculator.h"
 #include "Simulator.h"
+#include "BoundedQueue.h"
+#include "ThreadPool.h"
+#include "ResultCell.h"
+#include "InstructionsBuffer.h"
+
+#define PIPELINE_DEPTH 2 // Number of ports the algorithm may run ahead of the validation in pipelined mode
+#define PIPELINE_STAGE_COST std::numeric_limits<double>::max() // A started simulation's stage runs before new tasks
 
 using std::to_string;
 
@@ -24,9 +42,73 @@ using std::to_string;
  *  to the simulator as well.
  */
 
+/**
+ * The ship plan and the route of a scanned travel, shared read only by all of the travel's simulations.
+ * Each simulation copies it only once it starts running, so waiting tasks don't hold a copy of their own.
+ * It's also the parsed input of the algorithms that take one, each simulation holds it as long as its algorithm exists.
+ */
+struct TravelTemplate : public ParsedInput {
+    ShipPlan ship;
+    Route route;
+    Route route_as_read; // The route before the ports containers were loaded, as an algorithm reads it from its file
+    int plan_errors = 0; // Flags of the codes of the ship plan file's errors
+    int route_errors = 0; // Flags of the codes of the route file's errors
+
+    const ShipPlan &getShipPlan() const override {
+        return ship;
+    }
+
+    int getShipPlanErrors() const override {
+        return plan_errors;
+    }
+
+    const Route &getRoute() const override {
+        return route_as_read;
+    }
+
+    int getRouteErrors() const override {
+        return route_errors;
+    }
+
+    const CargoFile *getPortCargo(int port_num) const override {
+        return route.getPortCargo(port_num);
+    }
+};
+
+/**
+ * The containers of a port that no instruction has treated yet. An instruction treats the first untreated container
+ * with its ID, so only the number of untreated containers of each ID is kept while the instructions are validated.
+ */
+struct UntreatedContainers {
+    vector<string> ids; // The IDs of all of the port's containers, by their order
+    std::unordered_map<string, int> untreated; // ID -> number of its containers that no instruction has treated
+
+    explicit UntreatedContainers(vector<string> port_ids);
+
+    void treat(const string &id);
+
+    /**
+     * Returns the IDs of the untreated containers, by their order at the port.
+     */
+    vector<string> list() const;
+};
+
+/**
+ * The positions of a port's containers in their order by destination, the order Route::sortContainersByDestination
+ * gives them. Computed once per port visit, after its instructions were implemented, for the checks of the containers
+ * that were rejected or left at the port.
+ */
+struct DestinationOrder {
+    std::unordered_map<string, int> last_position; // Destination -> position of the last container with it
+    int farthest_loaded = -1; // Position of the last container that was loaded on the ship, -1 if there is none
+
+    DestinationOrder(const vector<Container> &containers, const Route &route);
+};
+
 //---Main class---//
 class Simulation {
 private:
+    std::shared_ptr<const TravelTemplate> travel_template; // Released once the simulation made its own copy
     ShipPlan ship;
     Route travel;
     WeightBalanceCalculator calc;
@@ -39,39 +121,109 @@ private:
     pair<string, std::function<std::unique_ptr<AbstractAlgorithm>()>> algo_name_and_ctor;
     string plan_path;
     string route_path;
+    bool pipelined_ports = false; // Run the algorithm on the next ports while the current one is validated
+    ThreadPool *thread_pool = nullptr; // Runs the stages of the pipelined ports, without it they run one by one
+    std::mutex stage_workers_mutex;
+    vector<std::shared_ptr<ThreadPool::WorkerState>> stage_workers; // The pool's workers that run a stage right now
+    bool instructions_channel = false; // The algorithm sends its instructions in memory, it registered the extension
+    bool instruction_files = true; // Write the crane instructions files to the output folder
+    bool parsed_input = false; // The algorithm takes the travel's parsed input, it registered the extension
+    std::shared_ptr<const TravelTemplate> algo_input; // The parsed input the algorithm views, released after it
+    std::unique_ptr<AbstractAlgorithm> algo; // Exists from startTravel() until finishTravel()
+    string instruction_file_path;
+    int num_of_operations = 0;
+    std::chrono::steady_clock::duration running_time{0}; // Time spent in this simulation's stages
+    std::shared_ptr<const vector<string>> ports_names; // The ports of the route, by their order
+    int curr_port_index = -1; // Index of the current port in ports_names
+    struct {
+        int floor, x, y;
+    } instruction_position = {-1, -1, -1}; // The position of the instruction that is implemented right now
+    int time_budget = 0; // Seconds the simulation may run, 0 if it's not limited
+    int errors_cap = 0; // Number of errors that are kept in detail, 0 if it's not limited
+    std::atomic_bool cancelled{false}; // The simulation ran out of its time budget and should stop
+    ResultCell *result_cell = nullptr; // Where the results and the errors go, owned by the simulator
+    std::atomic_int completed_ports{0};
+    std::optional<DestinationOrder> port_order; // Of the current port's containers, computed by the first check
+    std::function<void(int completed_ports, const string &port_name)> progress_listener;
 
 
-    inline static map<string, AbstractAlgorithm::Action> actionDic = {{"L", AbstractAlgorithm::Action::LOAD},
-                                                                      {"U", AbstractAlgorithm::Action::UNLOAD},
-                                                                      {"M", AbstractAlgorithm::Action::MOVE},
-                                                                      {"R", AbstractAlgorithm::Action::REJECT}};
+    /**
+     * Executing the ports of the travel while the algorithm runs on a second worker of the pool, up to PIPELINE_DEPTH
+     * ports ahead of the validation. Errors and operations are reported in the same order as the serial run.
+     */
+    void executePortsPipelined();
 
     /**
-     * Executing the travel simulation, returns false if any error has occurred.
+     * Runs a stage of the pipelined ports, while it runs the worker that runs it is given up with the simulation.
      */
-    bool
-    executeTravel(const string &algo_name, AbstractAlgorithm &algo, WeightBalanceCalculator &calc, int &num_of_errors);
+    void runStage(const std::function<void()> &stage);
+
+    /**
+     * Records an error of the current port, it's formatted to a message only once the results are collected.
+     */
+    void insertError(ErrorKind kind, const string &subject = "", int value = 0) {
+        ErrorRecord err{kind, curr_port_index, subject, instruction_position.floor, instruction_position.x,
+                        instruction_position.y, value};
+        if (errors_cap > 0 && (int) result_cell->errors.size() >= errors_cap) {
+            // Only counted from now on
+            DroppedErrors &dropped =
+                    result_cell->dropped_errors[{kind, kind == ErrorKind::AlgorithmReported ? value : 0}];
+            if (dropped.count++ == 0)
+                dropped.first = err;
+            dropped.last = std::move(err);
+            return;
+        }
+        result_cell->errors.push_back(std::move(err));
+    }
+
+    void insertResult(const string &num_of_op, bool err) {
+        result_cell->num_of_op = num_of_op;
+        result_cell->err_in_travel = err;
+    }
+
+    /**
+     * Reports the simulation as timed out with its last completed port.
+     */
+    void reportTimeout();
 
     /**
-     * Iterate over the instructions file and implementing only it's legal instructions.
+     * Counts a port that was executed completely and tells the progress listener about it.
+     */
+    void portCompleted();
+
+    /**
+     * Add the time that passed since @param since to the simulation's running time.
+     */
+    void addRunningTime(std::chrono::steady_clock::time_point since);
+
+    /**
+     * Cancels the simulation if its running time, with the phase that started at @param phase_start, is over its
+     * budget. Returns true if the simulation is cancelled.
+     */
+    bool overTimeBudget(std::chrono::steady_clock::time_point phase_start);
+
+    /**
+     * Runs the algorithm on a port and fills @param instructions with its instructions. They are sent in memory if
+     * the algorithm has the instructions channel, otherwise they are read back from the instructions file it writes.
+     */
+    int getPortInstructions(AbstractAlgorithm &algorithm, const string &cargo_file, const string &instruction_file,
+                            InstructionsBuffer &instructions);
+
+    /**
+     * Iterate over the port's instructions and implementing only it's legal instructions.
      */
     void
     iterateInstructions(WeightBalanceCalculator &calc,
-                        const string &instruction_file, int &num_of_operations, int num_of_algo);
+                        const InstructionsBuffer &instructions, int &num_of_operations);
 
     /**
      * Performs the instructions at the given instruction while validating the algorithm decisions.
+     * @param cont_id is the instruction's container ID.
      */
-    void implementInstruction(vector<string> &instruction, AbstractAlgorithm::Action command, int &num_of_operations,
-                              int num_of_algo, Port &current_port, WeightBalanceCalculator &calc,
+    void implementInstruction(const CraneInstruction &instruction, const string &cont_id, int &num_of_operations,
+                              Port &current_port, WeightBalanceCalculator &calc,
                               map<string, Container *> &rejected_containers,
-                              map<string, Container *> &unloaded_containers,
-                              int floor_num, int x, int y, Container *cont_to_load);
-
-    /**
-     * Validates the instruction format.
-     */
-    bool validateInstruction(const vector<string> &instructions);
+                              map<string, Container *> &unloaded_containers, Container *cont_to_load);
 
     /**
      * Validates a load instruction.
@@ -113,10 +265,16 @@ private:
      */
     void checkMissedContainers(const string &port_name);
 
+    /**
+     * Checks if the given container has destination that isn't closer than any container that was loaded on the ship
+     * from the current port.
+     */
+    bool checkSortedContainers(Port &curr_port, const string &cont_id);
+
     /**
      * Check if all the port containers were loaded on the ship or got rejected.
      */
-    void checkPortContainers(vector<string> &ignored_containers, Port &curr_port);
+    void checkPortContainers(const UntreatedContainers &ignored_containers, Port &curr_port);
 
     /**
      * Receives an integer representing error codes and add them to the errors log accordingly.
@@ -124,11 +282,12 @@ private:
     void analyzeErrCode(int err_code);
 
     /**
-     * Validates the instruction format and initializes parameters for the verification of instruction.
+     * Validates the instruction's container and initializes parameters for the verification of instruction.
+     * @param cont_id is the instruction's container ID.
      */
     bool
-    validateCargoInstruction(vector<string> &instruction, vector<string> &ignoredContainers, Container **cont_to_load,
-                             Port &current_port, AbstractAlgorithm::Action &command,
+    validateCargoInstruction(const CraneInstruction &instruction, const string &cont_id,
+                             UntreatedContainers &ignoredContainers, Container **cont_to_load, Port &current_port,
                              const map<string, Container *> &unloaded_containers);
 
     /**
@@ -138,22 +297,122 @@ private:
 
 public:
     //---Constructors and Destructors---//
-    explicit Simulation(ShipPlan &plan, Route &route, WeightBalanceCalculator &wcalc);
+    Simulation(std::shared_ptr<const TravelTemplate> travel_template, WeightBalanceCalculator &wcalc);
 
     /**
      * Initialize simulation members with the arguments given.
      */
     void initSimulation(int num_of_algo, int num_of_travel, string &travel_name,
                         pair<string, std::function<std::unique_ptr<AbstractAlgorithm>()>> &algo_p,
-                        const string &output_path, const string &plan_path, const string &route_path);
+                        const string &output_path, const string &plan_path, const string &route_path,
+                        ResultCell &cell);
 
     Simulation() = default;
 
+    void setPipelinedPorts(bool pipelined) {
+        this->pipelined_ports = pipelined;
+    }
+
+    /**
+     * Sets the pool the stages of the pipelined ports run in, so they don't add threads of their own.
+     */
+    void setThreadPool(ThreadPool *pool) {
+        this->thread_pool = pool;
+    }
+
+    void setInstructionsChannel(bool channel) {
+        this->instructions_channel = channel;
+    }
+
+    void setInstructionFiles(bool files) {
+        this->instruction_files = files;
+    }
+
+    void setParsedInput(bool parsed) {
+        this->parsed_input = parsed;
+    }
+
+    void setTimeBudget(int seconds) {
+        this->time_budget = seconds;
+    }
+
+    void setErrorsCap(int cap) {
+        this->errors_cap = cap;
+    }
+
+    /**
+     * Sets a function that is called each time a port is completed.
+     */
+    void setProgressListener(std::function<void(int completed_ports, const string &port_name)> listener) {
+        this->progress_listener = std::move(listener);
+    }
+
+    /**
+     * Asks the simulation to stop, it's checked between the ports. may be called from any thread.
+     */
+    void cancel() {
+        cancelled = true;
+    }
+
+    /**
+     * Gives up a simulation that is stuck: it's reported as timed out with its last completed port, and whatever its
+     * thread writes from now on is ignored. May be called from any thread, returns false if the simulation was done.
+     */
+    bool abandon();
+
+    /**
+     * Gives up the pool's workers that run the pipeline stages of a simulation that was given up. Their tasks count
+     * as done, so the pool may be done right after it: it's called once the simulation's results were handled.
+     */
+    void abandonStageWorkers();
+
+    /**
+     * Returns the timeout error message of a simulation that completed @param completed_ports of the route's ports.
+     */
+    static string timeoutMessage(const string &travel_name, int time_budget, const string &last_port,
+                                 int completed_ports, int num_of_ports);
+
+    /**
+     * Returns the message of the given error, of a travel with the given name and route.
+     */
+    static string formatError(const ErrorRecord &err, const string &travel_name, const vector<string> &ports_names);
+
+    int getTimeBudget() const {
+        return time_budget;
+    }
+
+    /**
+     * Returns true if the simulation was asked to stop, its results may depend on when it was asked.
+     */
+    bool isCancelled() const {
+        return cancelled;
+    }
+
+    int getNumOfAlgo() const {
+        return num_of_algo;
+    }
+
+    int getNumOfTravel() const {
+        return num_of_travel;
+    }
+
     /**
      * Main function that runs the simulation.
      */
     bool runSimulation();
 
+    /**
+     * The stages of runSimulation(), so a few simulations can be run port by port together.
+     * startTravel() creates the algorithm and gives it the travel, executeNextPort() executes a single port and
+     * returns false once the travel is over, finishTravel() reports the results and returns false if any error
+     * has occurred.
+     */
+    void startTravel();
+
+    bool executeNextPort();
+
+    bool finishTravel();
+
 };
 
 
@@ -1,12 +1,58 @@
 #include "Simulator.h"
+#include <sstream>
+#include <cstring>
 
 Simulator Simulator::inst;
-vector<vector<pair<string, int>>> Simulator::statistics;
+ResultsStore Simulator::results;
 vector<vector<vector<string>>> Simulator::errors;
 
-Simulator::Simulator(const string &output_path, unsigned int num_threads) : output_dir_path(output_path),
-                                                                            number_of_threads(num_threads),
-                                                                            err_occurred(false){
+#define HISTORY_FILE_NAME "simulation.history"
+#define SHARD_FILE_NAME "simulation.shard"
+#define JOURNAL_FILE_NAME "simulation.journal"
+#define STATUS_FILE_NAME "simulation.status"
+#define RESULTS_FILE_NAME "simulation.results"
+#define STORE_FILE_NAME "simulation.store"
+#define RANKINGS_FILE_NAME "simulation.rankings"
+#define PROCESS_SLOT_SIZE (256 * 1024) // Shared memory for the output of a single task of a worker process
+#define TRUNCATED_SLOT_LINE "truncated\n"
+#define TIMEOUT_GRACE std::chrono::seconds(2) // Time a simulation is given to stop after its budget is over
+
+#define INGESTION_COST std::numeric_limits<double>::max() // Scanning travels comes before running simulations
+
+/**
+ * Returns the error of a travel that its scan ran out of the time budget.
+ */
+string scanTimeoutMessage(const string &travel_name, int time_budget) {
+    return "@ Travel: " + travel_name + "- scanning the travel ran out of its time budget (" + to_string(time_budget) +
+           " seconds), it was not run.";
+}
+
+/**
+ * Returns the error of a pair that its worker process had more errors than its slot could hold.
+ */
+string truncatedSlotMessage(const string &travel_name) {
+    return "@ Travel: " + travel_name + "- too many errors to pass from the worker process, the rest were dropped.";
+}
+
+/**
+ * Splits a line of the shard file (or of a worker process slot, or of the journal) to @param num_of_fields fields, the last one takes the rest of the line.
+ */
+bool splitShardLine(const string &line, int num_of_fields, vector<string> &fields) {
+    fields.clear();
+    size_t field_start = 0;
+    for (int i = 0; i < num_of_fields - 1; ++i) {
+        size_t field_end = line.find(',', field_start);
+        if (field_end == string::npos)
+            return false;
+        fields.push_back(line.substr(field_start, field_end - field_start));
+        field_start = field_end + 1;
+    }
+    fields.push_back(line.substr(field_start));
+    return true;
+}
+
+Simulator::Simulator(const string &output_path, unsigned int num_threads, const RunOptions &options)
+        : output_dir_path(output_path), number_of_threads(num_threads), options(options), err_occurred(false) {
     vector<vector<string>> first_err_row;
     vector<string> temp_err_row;
 
@@ -21,29 +67,70 @@ Simulator::Simulator(const string &output_path, unsigned int num_threads) : outp
 }
 
 void Simulator::initializeResAndErrs() {
-    vector<pair<string, int>> new_res_row;
     vector<vector<string>> new_err_row;
     vector<string> temp_err_row;
+    vector<string> algos_names, travels_names;
 
-    statistics.push_back(new_res_row);
-    statistics[0].emplace_back("RESULTS", 0);
     for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
-        statistics.push_back(new_res_row);
-        statistics[num_of_algo].emplace_back(inst.algo_funcs[num_of_algo - 1].first, 0); // insert algorithm name
+        algos_names.push_back(inst.algo_funcs[num_of_algo - 1].first);
         errors.push_back(new_err_row);
         errors[num_of_algo].push_back(temp_err_row);
         errors[num_of_algo][0].push_back(inst.algo_funcs[num_of_algo - 1].first); // insert algorithm name
         for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
-            //Init statistics matrix
-            if (num_of_algo == 1)
-                statistics[0].emplace_back(travel_directories[num_of_travel - 1].filename(),
-                                           0); // creating a travel column
-            statistics[num_of_algo].emplace_back("0", 0); // Default statistic value
             //Init errors matrix
             errors[num_of_algo].push_back(temp_err_row);
         }
     }
-    statistics[0].emplace_back("Num Errors", 0); // creating a Num Errors column
+    for (auto &travel_dir : travel_directories) {
+        travels_names.push_back(travel_dir.filename());
+    }
+    results.create(algos_names, travels_names);
+    result_cells = std::make_unique<ResultCell[]>(inst.algo_funcs.size() * travel_directories.size());
+}
+
+vector<string> Simulator::formatCellErrors(const ResultCell &cell, int num_of_travel) const {
+    vector<string> messages;
+    string travel_name = travel_directories[num_of_travel - 1].filename();
+    const vector<string> no_ports;
+    messages.reserve(cell.errors.size());
+    const vector<string> &ports_names = cell.ports_names ? *cell.ports_names : no_ports;
+    for (auto &err : cell.errors) {
+        messages.push_back(Simulation::formatError(err, travel_name, ports_names));
+    }
+    for (auto &dropped : cell.dropped_errors) {
+        const DroppedErrors &summary = dropped.second;
+        string message = "@ Travel: " + travel_name + "- " + to_string(summary.count) +
+                         (summary.count == 1 ? " more error of this kind was" : " more errors of this kind were") +
+                         " not listed (over " + to_string(options.max_pair_errors) + " errors), the first: " +
+                         Simulation::formatError(summary.first, travel_name, ports_names);
+        if (summary.count > 1)
+            message += "; the last: " + Simulation::formatError(summary.last, travel_name, ports_names);
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+void Simulator::collectResultCells() {
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+            ResultCell &cell = getResultCell(num_of_algo, num_of_travel);
+            switch (cell.state.load(std::memory_order_acquire)) {
+                case ResultCell::Done:
+                    insertResult(num_of_algo, num_of_travel, cell.num_of_op, cell.err_in_travel);
+                    insertDuration(num_of_algo, num_of_travel, cell.duration);
+                    for (auto &err : formatCellErrors(cell, num_of_travel)) {
+                        insertError(num_of_algo, num_of_travel, err);
+                    }
+                    break;
+                case ResultCell::Abandoned: // Its thread may still write to the rest of the cell
+                    insertResult(num_of_algo, num_of_travel, "-1", true);
+                    insertError(num_of_algo, num_of_travel, cell.timeout_error);
+                    break;
+                case ResultCell::Empty:
+                    break; // Not run
+            }
+        }
+    }
 }
 
 bool Simulator::updateInput(string &algorithm_path) {
@@ -70,8 +157,22 @@ bool Simulator::updateInput(string &algorithm_path) {
     return true;
 }
 
-bool Simulator::scanTravelDir(ShipPlan &ship, Route &travel, string &plan_path, string &route_path,
-                              const std::filesystem::path &travel_dir) {
+/**
+ * Returns the flags of the codes of the errors from index @param from on, as an algorithm's FlagsSink gives them.
+ */
+int getErrorsFlags(const vector<pair<int, string>> &errs, size_t from) {
+    FlagsSink flags;
+    for (size_t i = from; i < errs.size(); ++i) {
+        flags.add(errs[i].first, [] { return string(); });
+    }
+    return flags.flags;
+}
+
+bool Simulator::scanTravelDir(TravelTemplate &scanned_travel, string &plan_path, string &route_path,
+                              const std::filesystem::path &travel_dir, const string &travel_name,
+                              vector<string> &travel_errs, ThreadPool &thread_pool) {
+    ShipPlan &ship = scanned_travel.ship;
+    Route &travel = scanned_travel.route;
     bool success_build = true, route_found = false, plan_found = false;
     vector<pair<int, string>> errs_in_ctor;
     vector<string> travel_files;
@@ -79,62 +180,100 @@ bool Simulator::scanTravelDir(ShipPlan &ship, Route &travel, string &plan_path,
     for (const auto &entry : std::filesystem::directory_iterator(travel_dir)) {
         if (endsWith(entry.path().filename(), ".ship_plan")) { // A ship plan file was found
             if (plan_found) {
-                errors[0][0].push_back(
-                        "@ Travel: " + this->curr_travel_name + " already found a ship plan file.");
-                err_occurred = true;
+                travel_errs.push_back("@ Travel: " + travel_name + " already found a ship plan file.");
                 continue;
             }
             plan_path = entry.path();
+            size_t first_err = errs_in_ctor.size();
             ship.initShipPlanFromFile(plan_path, errs_in_ctor, success_build);
+            scanned_travel.plan_errors = getErrorsFlags(errs_in_ctor, first_err);
             plan_found = true;
         } else if (endsWith(entry.path().filename(), ".route")) { // A route file was found
             if (route_found) {
-                errors[0][0].push_back("@ Travel: " + this->curr_travel_name + " already found a route file.");
-                err_occurred = true;
+                travel_errs.push_back("@ Travel: " + travel_name + " already found a route file.");
                 continue;
             }
             route_path = entry.path();
 
             travel = Route();
+            size_t first_err = errs_in_ctor.size();
             travel.initRouteFromFile(route_path, errs_in_ctor, success_build);
+            scanned_travel.route_errors = getErrorsFlags(errs_in_ctor, first_err);
             route_found = true;
         } else { // The rest of the files, may include some containers details.
             travel_files.push_back(entry.path().filename());
         }
     }
     if (!plan_found) {
-        errors[0][0].push_back("@ Travel: " + this->curr_travel_name + " has no Plan file.");
-        err_occurred = true;
+        travel_errs.push_back("@ Travel: " + travel_name + " has no Plan file.");
         return false;
     }
     if (!route_found) {
-        errors[0][0].push_back("@ Travel: " + this->curr_travel_name + " has no Route file.");
-        err_occurred = true;
+        travel_errs.push_back("@ Travel: " + travel_name + " has no Route file.");
         return false;
     }
     // Adding errors that were detected during Ship and Route builders
-    extractGeneralErrors(errs_in_ctor);
+    extractGeneralErrors(errs_in_ctor, travel_name, travel_errs);
     if (!success_build) {
-        err_occurred = true;
         return false; //One of the files of the travel is invalid, continue to the next travel.
     }
-    travel.initPorts(travel_dir, travel_files, errs_in_ctor, ship);
-    extractGeneralErrors(errs_in_ctor);
+    scanned_travel.route_as_read = travel;
+    // The cargo files that are not parsed within the time budget are skipped, and the travel is not run
+    auto scan_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(options.time_budget);
+    std::atomic_bool scan_timed_out{false};
+    travel.initPorts(travel_dir, travel_files, errs_in_ctor, ship,
+                     [this, &thread_pool, &scan_deadline, &scan_timed_out](vector<std::function<void()>> &jobs) {
+                         if (options.time_budget > 0) {
+                             for (auto &job : jobs) {
+                                 job = [job, &scan_deadline, &scan_timed_out] {
+                                     if (std::chrono::steady_clock::now() < scan_deadline)
+                                         job();
+                                     else
+                                         scan_timed_out = true;
+                                 };
+                             }
+                         }
+                         thread_pool.runJobs(jobs, INGESTION_COST);
+                     });
+    extractGeneralErrors(errs_in_ctor, travel_name, travel_errs);
+    if (scan_timed_out) {
+        travel_errs.push_back(scanTimeoutMessage(travel_name, options.time_budget));
+        return false;
+    }
     travel_files.clear();
     return true;
 }
 
+/**
+ * Returns the names of the algorithms (or the travels, if @param travels is true) that are listed in the manifest.
+ */
+std::set<string> getManifestNames(const map<pair<string, string>, PairSettings> &manifest, bool travels) {
+    std::set<string> names;
+    for (auto &pair_settings : manifest) {
+        names.insert(travels ? pair_settings.first.second : pair_settings.first.first);
+    }
+    return names;
+}
+
 bool Simulator::loadTravelsPaths(string &travels_dir_path) {
     bool empty_travel_dir = true; // Will become false once at least one folder found inside travels folder
+    std::set<string> manifest_travels = getManifestNames(options.manifest, true);
     for (const auto &travel_dir : std::filesystem::directory_iterator(
             travels_dir_path)) { // Foreach Travel, do the following:
         if (!std::filesystem::is_directory(travel_dir))
             continue;
+        // A travel that isn't listed in the manifest is still a column of the results, it's just not scanned
         travel_directories.push_back(travel_dir.path());
-        if (empty_travel_dir) empty_travel_dir = false;
+        if (options.manifest.empty() || manifest_travels.erase(travel_dir.path().filename()))
+            empty_travel_dir = false;
+    }
+    for (auto &travel_name : manifest_travels) {
+        errors[0][0].push_back("@ ERROR: Travel " + travel_name + " of the manifest was not found in the travels folder.");
+        err_occurred = true;
     }
     if (empty_travel_dir) { // No travel dir found
-        errors[0][0].push_back("@ FATAL ERROR: the given travels folder has no sub folders.");
+        errors[0][0].push_back(options.manifest.empty() ? "@ FATAL ERROR: the given travels folder has no sub folders."
+                                                        : "@ FATAL ERROR: none of the manifest's travels was found.");
         fillSimErrors();
         err_occurred = true;
         return false;
@@ -158,10 +297,17 @@ bool Simulator::validateAlgoLoad(void *handler, string &algo_name, int prev_size
 }
 
 void Simulator::loadAlgorithms(string &algorithm_path) {
-    int num_of_algo = 0;
     vector<string> algorithm_names = getSOFilesNames(algorithm_path);
+    std::set<string> manifest_algos = getManifestNames(options.manifest, false);
     for (auto &algo_name_so : algorithm_names) {
         string algo_name = algo_name_so.substr(0, (int) algo_name_so.length() - 3);
+        if (!options.manifest.empty() && !manifest_algos.erase(algo_name)) {
+            // Not listed in the manifest, it's still a row of the results but it's not even loaded
+            inst.algo_funcs.emplace_back(algo_name, nullptr);
+            inst.algo_extensions.push_back(NO_EXTENSIONS);
+            algos_hashes.push_back(0);
+            continue;
+        }
         int prev_size = (int) inst.algo_funcs.size();
         void *handler = dlopen((algorithm_path + std::filesystem::path::preferred_separator + algo_name_so).c_str(),
                                RTLD_LAZY);
@@ -169,16 +315,703 @@ void Simulator::loadAlgorithms(string &algorithm_path) {
             continue; // Algorithm loading failed, continue to the next algorithm.
         }
         handlers.push_back(handler);
+        algos_hashes.push_back(cache.isOpen() ? ResultsCache::hashFile(
+                algorithm_path + std::filesystem::path::preferred_separator + algo_name_so) : 0);
         // Set the new algorithm name
-        inst.algo_funcs[num_of_algo].first = algo_name;
-        num_of_algo++;
+        inst.algo_funcs.back().first = algo_name;
+    }
+    for (auto &algo_name : manifest_algos) {
+        errors[0][0].push_back("@ ERROR: Algorithm " + algo_name + " of the manifest was not found in the algorithms folder.");
+        err_occurred = true;
     }
 }
 
 void Simulator::markRemovedTravel(int num_of_travel) {
-    // Editing errors matrix
-    for (int num_of_algo = 0; num_of_algo < (int) statistics.size(); ++num_of_algo) {
-        statistics[num_of_algo][num_of_travel].second = -1; // Will be ignored when creating results file. Note that the '-1' is not related to the num_of_operations!
+    results.markTravelRemoved(num_of_travel); // Will be ignored when creating results file
+}
+
+long Simulator::estimateTravelCost(ShipPlan &ship, Route &travel) {
+    // Every port costs a scan of the whole ship, and so does every container that looks for a spot.
+    long cells = (long) ship.getNumOfDecks() * ship.getShipRows() * ship.getShipCols();
+    return cells * (travel.getNumOfPorts() + travel.getNumOfWaitingContainers());
+}
+
+void Simulator::loadCostHistory() {
+    FileHandler history_file(this->output_dir_path + std::filesystem::path::preferred_separator + HISTORY_FILE_NAME);
+    if (history_file.isFailed()) {
+        return; // No history, the tasks costs will be estimated
+    }
+    vector<string> line;
+    double sum_estimated = 0, sum_duration = 0;
+    while (history_file.getNextLineAsTokens(line)) {
+        if (line.size() != 4 || !isPositiveNumber(line[2]) || !isPositiveNumber(line[3]))
+            continue; // Ignore broken lines
+        CostRecord record{std::stol(line[2]), std::stol(line[3])};
+        cost_history[{line[0], line[1]}] = record;
+        sum_duration += (double) record.duration;
+        sum_estimated += (double) record.estimated_cost;
+    }
+    // Running times are scaled to the estimations units, so both kinds of costs can be compared
+    history_scale = (sum_duration > 0) ? sum_estimated / sum_duration : 0;
+}
+
+void Simulator::saveCostHistory() {
+    for (int num_of_algo = 1; num_of_algo <= results.getNumOfAlgos(); ++num_of_algo) {
+        for (int num_of_travel = 1; num_of_travel <= results.getNumOfTravels(); ++num_of_travel) {
+            if (results.getDuration(num_of_algo, num_of_travel) < 0)
+                continue; // The pair didn't run, keep its previous record
+            cost_history[{inst.algo_funcs[num_of_algo - 1].first, travel_directories[num_of_travel - 1].filename()}] =
+                    {results.getDuration(num_of_algo, num_of_travel), travels_estimates[num_of_travel - 1]};
+        }
+    }
+    FileHandler history_file(this->output_dir_path + std::filesystem::path::preferred_separator + HISTORY_FILE_NAME,
+                             true);
+    if (history_file.isFailed()) {
+        return;
+    }
+    for (auto &entry : cost_history) {
+        history_file.writeCell(entry.first.first);
+        history_file.writeCell(entry.first.second);
+        history_file.writeCell(to_string(entry.second.duration));
+        history_file.writeCell(to_string(entry.second.estimated_cost), true);
+    }
+}
+
+double Simulator::getTaskCost(const string &algo_name, const string &travel_name, long estimated_cost) {
+    auto prev = cost_history.find({algo_name, travel_name});
+    if (prev == cost_history.end() || history_scale <= 0)
+        return (double) estimated_cost;
+    return (double) prev->second.duration * history_scale; // Running time of the previous run is preferred
+}
+
+/**
+ * Returns the total size of the files in the given directory.
+ */
+std::uintmax_t getDirSize(const std::filesystem::path &dir) {
+    std::uintmax_t size = 0;
+    std::error_code err;
+    for (const auto &entry : std::filesystem::directory_iterator(dir, err)) {
+        if (!entry.is_regular_file(err))
+            continue;
+        std::uintmax_t file_size = entry.file_size(err);
+        if (!err)
+            size += file_size;
+    }
+    return size;
+}
+
+void Simulator::orderTravelsBySize() {
+    // Scan the biggest travels first, their simulations are probably the longest ones
+    vector<pair<std::uintmax_t, int>> travels_sizes;
+    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+        travels_sizes.emplace_back(getDirSize(travel_directories[num_of_travel - 1]), num_of_travel);
+    }
+    std::stable_sort(travels_sizes.begin(), travels_sizes.end(),
+                     [](const pair<std::uintmax_t, int> &t1, const pair<std::uintmax_t, int> &t2) {
+                         return t1.first > t2.first;
+                     });
+    ingest_order.clear();
+    for (auto &travel : travels_sizes) {
+        ingest_order.push_back(travel.second);
+    }
+}
+
+void Simulator::ingestTravels(ThreadPool &thread_pool, WeightBalanceCalculator &calc) {
+    auto num_of_travels = (int) travel_directories.size();
+    travels_errors.assign(num_of_travels, vector<string>());
+    travels_estimates.assign(num_of_travels, 0);
+    travels_hashes.assign(num_of_travels, 0);
+    orderTravelsBySize();
+    next_travel_to_ingest = 0;
+    // Leave some of the threads free to run the simulations of the travels that are ready
+    int num_of_scanners = std::max(1, (int) number_of_threads / 2);
+    for (int i = 0; i < num_of_scanners && i < num_of_travels; ++i) {
+        thread_pool.addTask([this, &thread_pool, &calc] { ingestNextTravel(thread_pool, calc); }, INGESTION_COST);
+    }
+}
+
+void Simulator::ingestNextTravel(ThreadPool &thread_pool, WeightBalanceCalculator &calc) {
+    int next = next_travel_to_ingest++;
+    if (next >= (int) ingest_order.size())
+        return; // All of the travels were taken
+    ingestTravel(ingest_order[next], thread_pool, calc);
+    thread_pool.addTask([this, &thread_pool, &calc] { ingestNextTravel(thread_pool, calc); }, INGESTION_COST);
+}
+
+std::shared_ptr<const TravelTemplate>
+Simulator::scanTravel(int num_of_travel, ThreadPool &thread_pool, string &plan_path, string &route_path) {
+    string travel_name = travel_directories[num_of_travel - 1].filename();
+    auto scanned_travel = std::make_shared<TravelTemplate>();
+    ShipPlan &ship = scanned_travel->ship;
+    Route &route = scanned_travel->route;
+    //Iterate over the directory
+    if (!scanTravelDir(*scanned_travel, plan_path, route_path, travel_directories[num_of_travel - 1], travel_name,
+                       travels_errors[num_of_travel - 1], thread_pool)) {
+        return nullptr;
+    }
+    travels_estimates[num_of_travel - 1] = estimateTravelCost(ship, route);
+    if (cache.isOpen())
+        travels_hashes[num_of_travel - 1] = ResultsCache::hashDir(travel_directories[num_of_travel - 1]);
+    route.shareWaitingContainers(); // The simulations copy a port's containers only when they arrive to it
+    return scanned_travel;
+}
+
+void Simulator::ingestTravel(int num_of_travel, ThreadPool &thread_pool, WeightBalanceCalculator &calc) {
+    if (!isTravelInShard(num_of_travel)) {
+        if (options.num_of_shards > 0)
+            markRemovedTravel(num_of_travel); // Belongs to other shards, left out of this shard's results
+        return; // Otherwise none of its pairs is listed in the manifest, its column is kept without results
+    }
+    string plan_path, route_path;
+    string travel_name = travel_directories[num_of_travel - 1].filename();
+    std::shared_ptr<const TravelTemplate> travel_template = scanTravel(num_of_travel, thread_pool, plan_path,
+                                                                       route_path);
+    if (!travel_template) {
+        markRemovedTravel(num_of_travel);
+        int num_of_pairs = 0;
+        for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+            num_of_pairs += isPairInShard(num_of_algo, num_of_travel) ? 1 : 0;
+        }
+        journal.addPairs(-num_of_pairs); // They won't run
+        return; // Fatal error detected. Skip to the next travel.
+    }
+    long estimated_cost = travels_estimates[num_of_travel - 1];
+    vector<std::shared_ptr<Simulation>> lockstep_sims;
+    double lockstep_cost = 0;
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        if (!isPairInShard(num_of_algo, num_of_travel) || isPairResumed(num_of_algo, num_of_travel))
+            continue; // Not this run's pair, or done by the interrupted run
+        if (loadFromCache(num_of_algo, num_of_travel)) { // Its inputs didn't change, it isn't simulated again
+            journal.pairsStarted(1);
+            journalPair(num_of_algo, num_of_travel);
+            continue;
+        }
+        auto sim = std::make_shared<Simulation>(travel_template, calc);
+        sim->initSimulation(num_of_algo, num_of_travel, travel_name, inst.algo_funcs[num_of_algo - 1],
+                            output_dir_path, plan_path, route_path, getResultCell(num_of_algo, num_of_travel));
+        sim->setTimeBudget(getTimeBudget(num_of_algo, num_of_travel));
+        sim->setErrorsCap(options.max_pair_errors);
+        sim->setInstructionsChannel(inst.hasExtension(num_of_algo, INSTRUCTIONS_CHANNEL));
+        sim->setParsedInput(inst.hasExtension(num_of_algo, PARSED_INPUT_VERSION));
+        sim->setInstructionFiles(options.instruction_files);
+        double cost = getTaskCost(inst.algo_funcs[num_of_algo - 1].first, travel_name, estimated_cost);
+        if (options.lockstep) {
+            lockstep_sims.push_back(sim);
+            lockstep_cost += cost;
+            continue;
+        }
+        sim->setPipelinedPorts(isPipelined(num_of_algo, num_of_travel));
+        sim->setThreadPool(&thread_pool);
+        thread_pool.addTask([this, sim, &thread_pool] {
+            runTask(thread_pool, {sim}, [&sim] { sim->runSimulation(); });
+        }, cost);
+    }
+    if (!lockstep_sims.empty()) {
+        thread_pool.addTask([this, lockstep_sims, &thread_pool]() mutable {
+            runTask(thread_pool, lockstep_sims, [&lockstep_sims] { runLockstep(lockstep_sims); });
+        }, lockstep_cost);
+    }
+}
+
+const PairSettings *Simulator::getPairSettings(int num_of_algo, int num_of_travel) const {
+    if (options.manifest.empty())
+        return nullptr;
+    auto pair_settings = options.manifest.find({inst.algo_funcs[num_of_algo - 1].first,
+                                                travel_directories[num_of_travel - 1].filename()});
+    return (pair_settings != options.manifest.end()) ? &pair_settings->second : nullptr;
+}
+
+int Simulator::getTimeBudget(int num_of_algo, int num_of_travel) const {
+    const PairSettings *pair_settings = getPairSettings(num_of_algo, num_of_travel);
+    if (pair_settings && pair_settings->time_budget >= 0)
+        return pair_settings->time_budget;
+    auto algo_budget = options.algos_time_budgets.find(inst.algo_funcs[num_of_algo - 1].first);
+    return (algo_budget != options.algos_time_budgets.end()) ? algo_budget->second : options.time_budget;
+}
+
+bool Simulator::isPipelined(int num_of_algo, int num_of_travel) const {
+    const PairSettings *pair_settings = getPairSettings(num_of_algo, num_of_travel);
+    if (pair_settings && pair_settings->pipelined_ports >= 0)
+        return pair_settings->pipelined_ports == 1;
+    return options.pipelined_ports;
+}
+
+void Simulator::runTask(ThreadPool &thread_pool, const vector<std::shared_ptr<Simulation>> &sims,
+                        const std::function<void()> &run) {
+    journal.pairsStarted((int) sims.size());
+    vector<int> entries;
+    if (watchdog) {
+        // Each simulation stops once its own running time is over its budget, the task's simulations run one after the
+        // other so it may take all of their budgets together. Beyond that the task is stuck, and it's given up.
+        int task_budget = 0;
+        bool unlimited = false; // Some simulation isn't limited, so the task is never given up
+        for (auto &sim : sims) {
+            if (sim->getTimeBudget() <= 0)
+                unlimited = true;
+            task_budget += std::max(sim->getTimeBudget(), 0);
+        }
+        if (task_budget > 0 && !unlimited) {
+            auto worker = ThreadPool::getCurrentWorker();
+            entries.push_back(watchdog->watch(std::chrono::seconds(task_budget),
+                                              [sims] {
+                                                  for (auto &sim : sims) {
+                                                      sim->cancel();
+                                                  }
+                                              },
+                                              [this, sims, worker, &thread_pool] {
+                                                  for (auto &sim : sims) {
+                                                      if (sim->abandon())
+                                                          journalPair(sim->getNumOfAlgo(), sim->getNumOfTravel());
+                                                  }
+                                                  abandoned_tasks++;
+                                                  for (auto &sim : sims) {
+                                                      sim->abandonStageWorkers();
+                                                  }
+                                                  thread_pool.abandonWorker(worker);
+                                              }));
+        }
+    }
+    run();
+    for (int entry : entries) {
+        watchdog->unwatch(entry);
+    }
+    for (auto &sim : sims) {
+        // A simulation that was given up meanwhile was journaled by the watchdog
+        if (getResultCell(sim->getNumOfAlgo(), sim->getNumOfTravel()).state.load(std::memory_order_acquire) ==
+            ResultCell::Done) {
+            journalPair(sim->getNumOfAlgo(), sim->getNumOfTravel());
+            if (!sim->isCancelled()) // A timed out result depends on the machine's load, it's not cached
+                storeInCache(sim->getNumOfAlgo(), sim->getNumOfTravel());
+        }
+    }
+}
+
+string Simulator::getCacheKey(int num_of_algo, int num_of_travel) const {
+    // The errors cap is the only setting that changes the pair's messages, an entry without instruction files is
+    // kept apart from the one with them
+    return ResultsCache::makeKey(inst.algo_funcs[num_of_algo - 1].first, algos_hashes[num_of_algo - 1],
+                                 travel_directories[num_of_travel - 1].filename(), travels_hashes[num_of_travel - 1],
+                                 "max_pair_errors=" + to_string(options.max_pair_errors) +
+                                 (options.instruction_files ? "" : ",instruction_files=false"));
+}
+
+void Simulator::fillDoneCell(ResultCell &cell, const ResultsCache::Entry &outcome) {
+    cell.num_of_op = outcome.numOfOp;
+    cell.err_in_travel = outcome.errInTravel;
+    cell.duration = outcome.duration;
+    for (auto &msg : outcome.errors) { // Already formatted, they are kept as they are
+        ErrorRecord err;
+        err.subject = msg;
+        cell.errors.push_back(std::move(err));
+    }
+    cell.state.store(ResultCell::Done, std::memory_order_release);
+}
+
+bool Simulator::loadFromCache(int num_of_algo, int num_of_travel) {
+    if (!cache.isOpen())
+        return false;
+    string algo_name = inst.algo_funcs[num_of_algo - 1].first;
+    string travel_name = travel_directories[num_of_travel - 1].filename();
+    string instructions_dir;
+    if (options.instruction_files) {
+        instructions_dir = createInstructionDir(output_dir_path, algo_name, travel_name);
+        if (instructions_dir.empty())
+            return false;
+    }
+    ResultsCache::Entry entry;
+    if (!cache.load(getCacheKey(num_of_algo, num_of_travel), entry, instructions_dir))
+        return false;
+    fillDoneCell(getResultCell(num_of_algo, num_of_travel), entry);
+    LOG_MESSAGE(Logger::getInstance(), LogLevel::Debug,
+                "Travel " + travel_name + " of " + algo_name + " was taken from the cache.");
+    return true;
+}
+
+void Simulator::storeInCache(int num_of_algo, int num_of_travel) {
+    if (!cache.isOpen())
+        return;
+    string algo_name = inst.algo_funcs[num_of_algo - 1].first;
+    string instructions_dir;
+    if (options.instruction_files) {
+        instructions_dir = createInstructionDir(output_dir_path, algo_name,
+                                                travel_directories[num_of_travel - 1].filename());
+        if (instructions_dir.empty())
+            return;
+    }
+    ResultCell &cell = getResultCell(num_of_algo, num_of_travel);
+    ResultsCache::Entry entry{cell.err_in_travel, cell.duration, cell.err_in_travel ? "-1" : cell.num_of_op,
+                              formatCellErrors(cell, num_of_travel)};
+    cache.store(getCacheKey(num_of_algo, num_of_travel), entry, instructions_dir);
+}
+
+string Simulator::getPairRecords(int num_of_algo, int num_of_travel) {
+    ResultCell &cell = getResultCell(num_of_algo, num_of_travel);
+    string pair_nums = to_string(num_of_algo) + "," + to_string(num_of_travel);
+    string records;
+    if (cell.state.load(std::memory_order_acquire) == ResultCell::Abandoned) {
+        records = "result," + pair_nums + ",1,-1,-1\n";
+        records += "error," + pair_nums + "," + cell.timeout_error + "\n";
+    } else {
+        records = "result," + pair_nums + (cell.err_in_travel ? ",1," : ",0,") + to_string(cell.duration) + "," +
+                  (cell.err_in_travel ? "-1" : cell.num_of_op) + "\n";
+        for (auto &err : formatCellErrors(cell, num_of_travel)) {
+            records += "error," + pair_nums + "," + err + "\n";
+        }
+    }
+    // A resumed run takes the pair only if all of its records were written
+    return records + "done," + pair_nums + "\n";
+}
+
+void Simulator::journalPair(int num_of_algo, int num_of_travel) {
+    journal.append(getPairRecords(num_of_algo, num_of_travel), 1);
+}
+
+void Simulator::journalProcessTask(int task, const char *slot) {
+    int num_of_algo = process_tasks[task].first;
+    int num_of_travel = process_tasks[task].second;
+    if (num_of_algo == 0)
+        return; // Only scanned the travel, its general errors are not journaled
+    string pair_nums = to_string(num_of_algo) + "," + to_string(num_of_travel);
+    size_t length;
+    memcpy(&length, slot, sizeof(size_t));
+    std::istringstream slot_lines(string(slot + sizeof(size_t), length));
+    string line, type, records;
+    vector<string> fields;
+    while (std::getline(slot_lines, line)) {
+        type = line.substr(0, line.find(','));
+        if (type == "result" && splitShardLine(line, 5, fields)) {
+            records += "result," + pair_nums + "," + fields[1] + "," + fields[2] + "," + fields[4] + "\n";
+        } else if (type == "error" && splitShardLine(line, 2, fields)) {
+            records += "error," + pair_nums + "," + fields[1] + "\n";
+        } else if (line + "\n" == TRUNCATED_SLOT_LINE) {
+            records += "error," + pair_nums + "," +
+                       truncatedSlotMessage(travel_directories[num_of_travel - 1].filename()) + "\n";
+        }
+    }
+    if (records.empty())
+        return; // The travel had a fatal error, the pair didn't run
+    journal.pairsStarted(1);
+    journal.append(records + "done," + pair_nums + "\n", 1);
+}
+
+void Simulator::resumeJournal() {
+    std::ifstream journal_file(this->output_dir_path + std::filesystem::path::preferred_separator +
+                               JOURNAL_FILE_NAME);
+    if (!journal_file.is_open()) {
+        LOG_MESSAGE(Logger::getInstance(), LogLevel::Warning,
+                    "WARNING: No journal to resume in " + this->output_dir_path + ", all of the pairs are run.");
+        return;
+    }
+    resumed_pairs.assign(inst.algo_funcs.size() * travel_directories.size(), false);
+    // The interrupted run may have listed the algorithms and the travels in another order, they are matched by names
+    map<string, int> algos_nums, travels_nums;
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        algos_nums[inst.algo_funcs[num_of_algo - 1].first] = num_of_algo;
+    }
+    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+        travels_nums[travel_directories[num_of_travel - 1].filename()] = num_of_travel;
+    }
+    vector<int> algos_map, travels_map; // The journal's numbers -> this run's numbers, 0 if it's not in this run
+    map<pair<int, int>, ResultsCache::Entry> pending; // Pairs that their done record wasn't read yet
+    string line, type;
+    vector<string> fields;
+    // Returns this run's pair of the given journal's numbers, (0, 0) if it's not one of the pairs of this run
+    auto mapPair = [this, &algos_map, &travels_map](const string &num_of_algo, const string &num_of_travel) {
+        if (!isPositiveNumber(num_of_algo) || !isPositiveNumber(num_of_travel) || string2int(num_of_algo) < 1 ||
+            string2int(num_of_algo) > (int) algos_map.size() || string2int(num_of_travel) < 1 ||
+            string2int(num_of_travel) > (int) travels_map.size())
+            return std::make_pair(0, 0);
+        auto run_pair = std::make_pair(algos_map[string2int(num_of_algo) - 1],
+                                       travels_map[string2int(num_of_travel) - 1]);
+        if (run_pair.first == 0 || run_pair.second == 0 || !isPairInShard(run_pair.first, run_pair.second))
+            return std::make_pair(0, 0);
+        return run_pair;
+    };
+    while (std::getline(journal_file, line)) {
+        type = line.substr(0, line.find(','));
+        if (type == "algo" && splitShardLine(line, 2, fields)) {
+            auto algo = algos_nums.find(fields[1]);
+            algos_map.push_back(algo != algos_nums.end() ? algo->second : 0);
+        } else if (type == "travel" && splitShardLine(line, 2, fields)) {
+            auto travel = travels_nums.find(fields[1]);
+            travels_map.push_back(travel != travels_nums.end() ? travel->second : 0);
+        } else if (type == "result" && splitShardLine(line, 6, fields)) {
+            auto run_pair = mapPair(fields[1], fields[2]);
+            if (run_pair.first == 0)
+                continue;
+            ResultsCache::Entry &outcome = pending[run_pair];
+            outcome = ResultsCache::Entry{fields[3] == "1", std::strtol(fields[4].c_str(), nullptr, 10), fields[5], {}};
+        } else if (type == "error" && splitShardLine(line, 4, fields)) {
+            auto outcome = pending.find(mapPair(fields[1], fields[2]));
+            if (outcome != pending.end())
+                outcome->second.errors.push_back(fields[3]);
+        } else if (type == "done" && splitShardLine(line, 3, fields)) {
+            auto run_pair = mapPair(fields[1], fields[2]);
+            auto outcome = pending.find(run_pair);
+            if (outcome == pending.end() || isPairResumed(run_pair.first, run_pair.second))
+                continue;
+            fillDoneCell(getResultCell(run_pair.first, run_pair.second), outcome->second);
+            resumed_pairs[(size_t) (run_pair.first - 1) * travel_directories.size() + (run_pair.second - 1)] = true;
+            pending.erase(outcome);
+        }
+    }
+}
+
+bool Simulator::readJournal() {
+    std::ifstream journal_file(this->output_dir_path + std::filesystem::path::preferred_separator +
+                               JOURNAL_FILE_NAME);
+    if (!journal_file.is_open())
+        return false;
+    string line, type;
+    vector<string> fields;
+    auto num_of_algos = (int) inst.algo_funcs.size(), num_of_travels = (int) travel_directories.size();
+    auto validIndexes = [num_of_algos, num_of_travels](const string &num_of_algo, const string &num_of_travel) {
+        return isPositiveNumber(num_of_algo) && string2int(num_of_algo) >= 1 &&
+               string2int(num_of_algo) <= num_of_algos && isPositiveNumber(num_of_travel) &&
+               string2int(num_of_travel) >= 1 && string2int(num_of_travel) <= num_of_travels;
+    };
+    while (std::getline(journal_file, line)) {
+        type = line.substr(0, line.find(','));
+        if (type == "result" && splitShardLine(line, 6, fields) && validIndexes(fields[1], fields[2])) {
+            insertResult(string2int(fields[1]), string2int(fields[2]), fields[5], fields[3] == "1");
+            insertDuration(string2int(fields[1]), string2int(fields[2]), std::stol(fields[4]));
+        } else if (type == "error" && splitShardLine(line, 4, fields) && validIndexes(fields[1], fields[2])) {
+            insertError(string2int(fields[1]), string2int(fields[2]), fields[3]);
+        }
+        // The names of the algorithms and the travels are listed for the readers of the journal, this run knows them.
+        // The done records matter only to a run that is resumed
+    }
+    return true;
+}
+
+bool Simulator::openJournal() {
+    vector<string> algos_names, travels_names;
+    int num_of_pairs = 0, num_of_resumed = 0;
+    string resumed_records;
+    for (auto &algo : inst.algo_funcs) {
+        algos_names.push_back(algo.first);
+    }
+    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+        travels_names.push_back(travel_directories[num_of_travel - 1].filename());
+        for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+            if (isPairInShard(num_of_algo, num_of_travel))
+                num_of_pairs++;
+            if (isPairResumed(num_of_algo, num_of_travel)) {
+                resumed_records += getPairRecords(num_of_algo, num_of_travel);
+                num_of_resumed++;
+            }
+        }
+    }
+    string dir = this->output_dir_path + std::filesystem::path::preferred_separator;
+    return journal.open(dir + JOURNAL_FILE_NAME, dir + STATUS_FILE_NAME, algos_names, travels_names, num_of_pairs,
+                        resumed_records, num_of_resumed);
+}
+
+void Simulator::runLockstep(vector<std::shared_ptr<Simulation>> &sims) {
+    for (auto &sim : sims) {
+        sim->startTravel();
+    }
+    bool ports_left = true;
+    while (ports_left) { // For each port in travel, all of the simulations share the same route
+        ports_left = false;
+        for (auto &sim : sims) {
+            ports_left = sim->executeNextPort() || ports_left;
+        }
+    }
+    for (auto &sim : sims) {
+        sim->finishTravel();
+    }
+}
+
+/**
+ * Writes the given lines to a shared memory slot, preceded by their length. lines that don't fit are dropped.
+ */
+void writeToSlot(string lines, char *slot, size_t slot_size) {
+    size_t capacity = slot_size - sizeof(size_t);
+    if (lines.size() > capacity) {
+        size_t last_line_end = lines.rfind('\n', capacity - strlen(TRUNCATED_SLOT_LINE) - 1);
+        lines.erase(last_line_end == string::npos ? 0 : last_line_end + 1);
+        lines += TRUNCATED_SLOT_LINE;
+    }
+    size_t length = lines.size();
+    memcpy(slot, &length, sizeof(size_t));
+    memcpy(slot + sizeof(size_t), lines.data(), length);
+}
+
+void Simulator::runProcessTask(int task, WorkerTravel &worker_travel, WeightBalanceCalculator &calc, char *slot,
+                               size_t slot_size) {
+    int num_of_algo = process_tasks[task].first;
+    int num_of_travel = process_tasks[task].second;
+    if (worker_travel.num_of_travel != num_of_travel) { // The travel is scanned once for the worker's next pairs
+        ThreadPool thread_pool(1); // The worker process has no threads, the cargo files are parsed one by one
+        travels_errors[num_of_travel - 1].clear();
+        worker_travel.num_of_travel = num_of_travel;
+        worker_travel.travel_template = scanTravel(num_of_travel, thread_pool, worker_travel.plan_path,
+                                                   worker_travel.route_path);
+    }
+    // Lines in the manner of the shard file, the pair is known by the task's number
+    string lines;
+    if (worker_travel.travel_template && num_of_algo > 0) {
+        string travel_name = travel_directories[num_of_travel - 1].filename();
+        ResultCell &cell = getResultCell(num_of_algo, num_of_travel);
+        if (!loadFromCache(num_of_algo, num_of_travel)) {
+            Simulation sim(worker_travel.travel_template, calc);
+            sim.initSimulation(num_of_algo, num_of_travel, travel_name, inst.algo_funcs[num_of_algo - 1],
+                               output_dir_path, worker_travel.plan_path, worker_travel.route_path, cell);
+            sim.setPipelinedPorts(isPipelined(num_of_algo, num_of_travel));
+            sim.setTimeBudget(getTimeBudget(num_of_algo, num_of_travel));
+            sim.setErrorsCap(options.max_pair_errors);
+            sim.setInstructionsChannel(inst.hasExtension(num_of_algo, INSTRUCTIONS_CHANNEL));
+            sim.setParsedInput(inst.hasExtension(num_of_algo, PARSED_INPUT_VERSION));
+            sim.setInstructionFiles(options.instruction_files);
+            // If the worker is killed for running out of time, the parent finds the last completed port in the slot
+            string num_of_ports = to_string(worker_travel.travel_template->route.getNumOfPorts());
+            auto progress_listener = [slot, slot_size, num_of_ports](int completed_ports, const string &port_name) {
+                writeToSlot("progress," + to_string(completed_ports) + "," + num_of_ports + "," + port_name + "\n",
+                            slot, slot_size);
+            };
+            progress_listener(0, "");
+            sim.setProgressListener(progress_listener);
+            sim.runSimulation();
+            if (!sim.isCancelled()) // A timed out result depends on the machine's load, it's not cached
+                storeInCache(num_of_algo, num_of_travel);
+        }
+        lines += "result," + to_string(cell.err_in_travel ? 1 : 0) + "," + to_string(cell.duration) + "," +
+                 to_string(travels_estimates[num_of_travel - 1]) + "," + (cell.err_in_travel ? "-1" : cell.num_of_op) +
+                 "\n";
+        for (auto &err : formatCellErrors(cell, num_of_travel)) {
+            lines += "error," + err + "\n";
+        }
+    }
+    if (!worker_travel.travel_template)
+        lines += "removed\n";
+    for (auto &err : travels_errors[num_of_travel - 1]) {
+        lines += "travel_error," + err + "\n";
+    }
+    writeToSlot(lines, slot, slot_size);
+}
+
+void Simulator::collectProcessTask(int task, const char *slot, vector<bool> &merged_travels) {
+    int num_of_algo = process_tasks[task].first;
+    int num_of_travel = process_tasks[task].second;
+    string travel_name = travel_directories[num_of_travel - 1].filename();
+    // The travel's general errors are taken from the first pair of the travel, like a single scan would report them
+    bool first_of_travel = !merged_travels[num_of_travel - 1];
+    merged_travels[num_of_travel - 1] = true;
+    size_t length;
+    memcpy(&length, slot, sizeof(size_t));
+    std::istringstream slot_lines(string(slot + sizeof(size_t), length));
+    string line, type;
+    vector<string> fields;
+    while (std::getline(slot_lines, line)) {
+        type = line.substr(0, line.find(','));
+        if (type == "result" && splitShardLine(line, 5, fields)) {
+            insertResult(num_of_algo, num_of_travel, fields[4], fields[1] == "1");
+            insertDuration(num_of_algo, num_of_travel, std::stol(fields[2]));
+            travels_estimates[num_of_travel - 1] = std::stol(fields[3]);
+        } else if (type == "error" && splitShardLine(line, 2, fields)) {
+            insertError(num_of_algo, num_of_travel, fields[1]);
+        } else if (type == "removed" && first_of_travel) {
+            markRemovedTravel(num_of_travel);
+        } else if (type == "travel_error" && first_of_travel && splitShardLine(line, 2, fields)) {
+            travels_errors[num_of_travel - 1].push_back(fields[1]);
+        } else if (line + "\n" == TRUNCATED_SLOT_LINE && num_of_algo > 0) {
+            insertError(num_of_algo, num_of_travel, truncatedSlotMessage(travel_name));
+        }
+    }
+}
+
+string Simulator::timedOutProcessMessage(int task, const char *slot) {
+    int num_of_algo = process_tasks[task].first;
+    string travel_name = travel_directories[process_tasks[task].second - 1].filename();
+    int time_budget = num_of_algo > 0 ? getTimeBudget(num_of_algo, process_tasks[task].second) : options.time_budget;
+    size_t length;
+    memcpy(&length, slot, sizeof(size_t));
+    string line(slot + sizeof(size_t), length);
+    vector<string> fields;
+    if (num_of_algo == 0 || line.rfind("progress,", 0) != 0 ||
+        !splitShardLine(line.substr(0, line.find('\n')), 4, fields))
+        return scanTimeoutMessage(travel_name, time_budget); // Killed before the simulation has started
+    return Simulation::timeoutMessage(travel_name, time_budget, fields[3], string2int(fields[1]),
+                                      string2int(fields[2]));
+}
+
+bool Simulator::runInWorkerProcesses(WeightBalanceCalculator &calc) {
+    auto num_of_travels = (int) travel_directories.size();
+    travels_errors.assign(num_of_travels, vector<string>());
+    travels_estimates.assign(num_of_travels, 0);
+    travels_hashes.assign(num_of_travels, 0);
+    orderTravelsBySize();
+    // The pairs of a travel follow each other, so a worker usually scans a travel once for a few pairs
+    process_tasks.clear();
+    for (int num_of_travel : ingest_order) {
+        if (!isTravelInShard(num_of_travel)) {
+            if (options.num_of_shards > 0)
+                markRemovedTravel(num_of_travel); // Belongs to other shards, left out of this shard's results
+            continue; // Otherwise none of its pairs is listed in the manifest, its column is kept without results
+        }
+        size_t travel_tasks = process_tasks.size();
+        for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+            if (isPairInShard(num_of_algo, num_of_travel) && !isPairResumed(num_of_algo, num_of_travel))
+                process_tasks.emplace_back(num_of_algo, num_of_travel);
+        }
+        if (process_tasks.size() == travel_tasks) // Nothing to run, the travel is still scanned for its errors
+            process_tasks.emplace_back(0, num_of_travel);
+    }
+    ProcessPool process_pool((int) number_of_threads, (int) process_tasks.size(), PROCESS_SLOT_SIZE);
+    if (!process_pool.isReady())
+        return false;
+    WorkerTravel worker_travel; // Each worker process changes its own copy
+    ProcessPool::BudgetFunc task_budget = nullptr;
+    if (hasTimeBudgets()) {
+        task_budget = [this](int task) {
+            return process_tasks[task].first > 0 ? getTimeBudget(process_tasks[task].first, process_tasks[task].second)
+                                                 : options.time_budget;
+        };
+    }
+    // The pairs are journaled and collected as the workers are done with them, so a run that is killed can be resumed
+    // and the slots of the pairs are released right away
+    bool journaled = openJournal();
+    vector<bool> merged_travels(num_of_travels, false);
+    vector<ProcessPool::FailedTask> failed_tasks = process_pool.run(
+            [this, &worker_travel, &calc](int task, char *slot, size_t slot_size) {
+                runProcessTask(task, worker_travel, calc, slot, slot_size);
+            }, task_budget, [this, &process_pool, &merged_travels, journaled](int task) {
+                if (journaled)
+                    journalProcessTask(task, process_pool.getSlot(task));
+                collectProcessTask(task, process_pool.getSlot(task), merged_travels);
+            });
+    for (auto &failed_task : failed_tasks) {
+        int num_of_algo = process_tasks[failed_task.task].first;
+        int num_of_travel = process_tasks[failed_task.task].second;
+        string travel_name = travel_directories[num_of_travel - 1].filename();
+        string err_msg = failed_task.timedOut ?
+                         timedOutProcessMessage(failed_task.task, process_pool.getSlot(failed_task.task)) :
+                         "@ Travel: " + travel_name + "- the worker process crashed, it was " +
+                         ProcessPool::describeStatus(failed_task.status) + ".";
+        if (num_of_algo == 0) {
+            travels_errors[num_of_travel - 1].push_back(err_msg);
+            markRemovedTravel(num_of_travel);
+            continue;
+        }
+        insertResult(num_of_algo, num_of_travel, "-1", true);
+        insertError(num_of_algo, num_of_travel, err_msg);
+        string pair_nums = to_string(num_of_algo) + "," + to_string(num_of_travel);
+        journal.pairsStarted(1);
+        journal.append("result," + pair_nums + ",1,-1,-1\nerror," + pair_nums + "," + err_msg + "\ndone," +
+                       pair_nums + "\n", 1);
+    }
+    journal.close();
+    collectResultCells(); // Only the cells of the resumed pairs are filled in this process
+    return true;
+}
+
+void Simulator::mergeTravelsErrors() {
+    // Travels are merged by their order, regardless of the order they were scanned in
+    for (auto &travel_errs : travels_errors) {
+        if (!travel_errs.empty())
+            err_occurred = true; //at least one error was found
+        errors[0][0].insert(errors[0][0].end(), travel_errs.begin(), travel_errs.end());
     }
 }
 
@@ -199,35 +1032,54 @@ bool Simulator::start(string algorithm_path, string travels_dir_path) {
     if (!loadTravelsPaths(travels_dir_path))
         return false;
 
+    if (!options.cache_dir.empty() && !cache.open(options.cache_dir)) {
+        errors[0][0].push_back("@ ERROR: The cache folder " + options.cache_dir + " can't be used, no pair is cached.");
+        err_occurred = true;
+    }
     loadAlgorithms(algorithm_path);
     initializeResAndErrs();
+    initShardRanks();
+    if (options.resume)
+        resumeJournal();
+    loadCostHistory();
     WeightBalanceCalculator calc;
 
-    // Launch simulation!
-    ThreadPool thread_pool((int)number_of_threads - 1);
-    thread_pool.start();
-    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
-        string plan_path, route_path;
-        this->curr_travel_name = travel_directories[num_of_travel - 1].filename();
-        ShipPlan ship;
-        Route route;
-        //Iterate over the directory
-        if (!scanTravelDir(ship, route, plan_path, route_path, travel_directories[num_of_travel - 1])) {
-            markRemovedTravel(num_of_travel);
-            continue; // Fatal error detected. Skip to the next travel.
-        }
-        for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
-            Simulation sim(ship, route, calc);
-            sim.initSimulation(num_of_algo, num_of_travel, curr_travel_name, inst.algo_funcs[num_of_algo - 1],
-                               output_dir_path, plan_path, route_path);
-//            sim.runSimulation();
-            thread_pool.getTask(sim);
-        }
+    // Launch simulation! the travels are scanned by the pool as well, and the simulations of each travel are given
+    // to the pool once it is ready. the current thread joins the pool as a worker.
+    if (!options.worker_processes || !runInWorkerProcesses(calc)) {
+        // With time budgets, every task runs on a worker thread, so a stuck one can be given up and left behind
+        if (hasTimeBudgets())
+            watchdog = std::make_unique<Watchdog>(TIMEOUT_GRACE);
+        auto thread_pool = std::make_unique<ThreadPool>((int) number_of_threads, !watchdog);
+        // The results are journaled as the simulations are done, and the output files are assembled from the journal
+        bool journaled = openJournal();
+        Logger::getInstance().start(); // The worker threads don't wait for the standard output
+        thread_pool->start();
+        ingestTravels(*thread_pool, calc);
+        thread_pool->finish();
+        Logger::getInstance().stop();
+        journal.close();
+        if (!journaled || !readJournal())
+            collectResultCells(); // The journal couldn't be written, the results are taken from the cells
+        if (abandoned_tasks > 0)
+            thread_pool.release(); // Left behind threads may still use it once their algorithm returns
     }
-    thread_pool.finish();
+    if (options.num_of_shards > 0)
+        writeShardFile();
+    mergeTravelsErrors();
+    saveCostHistory();
 
     inst.algo_funcs.clear();
-    for (auto &hndl:handlers) { dlclose(hndl); }
+    inst.algo_extensions.clear();
+    if (abandoned_tasks == 0) { // Left behind threads may still run the algorithms code
+        for (auto &hndl:handlers) { dlclose(hndl); }
+    }
+    createOutputFiles();
+
+    return true; // No fatal errors were detected
+}
+
+void Simulator::createOutputFiles() {
     for(int i = 0; i < (int)errors.size(); i++){
         bool broke = false;
         for(int j = 0; j < (int)errors[0].size(); j++){
@@ -243,83 +1095,299 @@ bool Simulator::start(string algorithm_path, string travels_dir_path) {
     if (err_occurred) // Errors found, errors_file should be created
         fillSimErrors();
     createResultsFile();
+}
 
-    return true; // No fatal errors were detected
+/**
+ * Returns the position of each name among the sorted names.
+ */
+vector<int> rankNames(const vector<string> &names) {
+    vector<int> order(names.size());
+    for (int i = 0; i < (int) names.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&names](int n1, int n2) { return names[n1] < names[n2]; });
+    vector<int> ranks(names.size());
+    for (int rank = 0; rank < (int) order.size(); ++rank) {
+        ranks[order[rank]] = rank;
+    }
+    return ranks;
 }
 
-void Simulator::extractGeneralErrors(vector<pair<int, string>> &err_strings) {
-    if (!err_strings.empty())
-        err_occurred = true; //at least one error was found
-    for (int i = 0; i < (int) err_strings.size(); ++i) {
-        errors[0][0].push_back("@ Travel: " + curr_travel_name + "- " + err_strings[i].second);
+void Simulator::initShardRanks() {
+    vector<string> names;
+    for (auto &algo : inst.algo_funcs) {
+        names.push_back(algo.first);
     }
-    err_strings.clear(); // Clearing the errors list for future re-use.
+    algos_ranks = rankNames(names);
+    names.clear();
+    for (auto &travel_dir : travel_directories) {
+        names.push_back(travel_dir.filename());
+    }
+    travels_ranks = rankNames(names);
+    manifest_pairs.clear();
+    if (options.manifest.empty())
+        return;
+    for (auto &algo : inst.algo_funcs) {
+        for (auto &travel_dir : travel_directories) {
+            manifest_pairs.push_back(options.manifest.count({algo.first, travel_dir.filename()}) > 0);
+        }
+    }
+}
+
+bool Simulator::isPairInShard(int num_of_algo, int num_of_travel) const {
+    if (!manifest_pairs.empty() &&
+        !manifest_pairs[(size_t) (num_of_algo - 1) * travel_directories.size() + (num_of_travel - 1)])
+        return false;
+    if (options.num_of_shards == 0)
+        return true;
+    // The pairs are dealt to the shards one by one, ordered by the algorithm's name and then by the travel's name
+    long pair_num = (long) algos_ranks[num_of_algo - 1] * (long) travels_ranks.size() + travels_ranks[num_of_travel - 1];
+    return pair_num % options.num_of_shards == options.shard_index;
+}
+
+bool Simulator::isTravelInShard(int num_of_travel) const {
+    if (options.num_of_shards == 0 && manifest_pairs.empty())
+        return true;
+    if (inst.algo_funcs.empty()) // Nothing to run, the travels are still scanned for their errors
+        return options.num_of_shards == 0 ||
+               travels_ranks[num_of_travel - 1] % options.num_of_shards == options.shard_index;
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        if (isPairInShard(num_of_algo, num_of_travel))
+            return true;
+    }
+    return false;
 }
 
-void Simulator::addSumColumn() {
-    int sum;
-    auto num_of_algos = (int) statistics.size();
-    auto num_of_travels = (int) statistics[0].size() - 1; // -1 so we ignore the Errors column.
-    statistics[0].insert(statistics[0].end() - 1, pair("Sum", 0));
-    for (int i = 1; i < num_of_algos; ++i) {
-        sum = 0;
-        for (int j = 1; j < num_of_travels; ++j) {
-            if (statistics[i][j].first == "-1") continue; // Ignore travels with errors
-            sum += string2int(statistics[i][j].first);
+void Simulator::writeShardFile() {
+    FileHandler shard_file(this->output_dir_path + std::filesystem::path::preferred_separator + SHARD_FILE_NAME, true);
+    if (shard_file.isFailed()) {
+        return;
+    }
+    // Names and messages are always the last field of a line, so they may contain commas
+    shard_file.writeCell("shard");
+    shard_file.writeCell(to_string(options.shard_index));
+    shard_file.writeCell(to_string(options.num_of_shards), true);
+    for (auto &algo : inst.algo_funcs) {
+        shard_file.writeCell("algo");
+        shard_file.writeCell(algo.first, true);
+    }
+    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+        bool scanned = isTravelInShard(num_of_travel);
+        shard_file.writeCell("travel");
+        shard_file.writeCell(scanned ? "1" : "0");
+        shard_file.writeCell(scanned && results.isTravelRemoved(num_of_travel) ? "1" : "0");
+        shard_file.writeCell(travel_directories[num_of_travel - 1].filename(), true);
+    }
+    for (int i = 1; i < (int) errors[0][0].size(); ++i) {
+        shard_file.writeCell("general");
+        shard_file.writeCell(errors[0][0][i], true);
+    }
+    for (int num_of_travel = 1; num_of_travel <= (int) travels_errors.size(); ++num_of_travel) {
+        for (auto &err : travels_errors[num_of_travel - 1]) {
+            shard_file.writeCell("travel_error");
+            shard_file.writeCell(to_string(num_of_travel));
+            shard_file.writeCell(err, true);
+        }
+    }
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+            if (!isPairInShard(num_of_algo, num_of_travel) || results.isTravelRemoved(num_of_travel))
+                continue; // The pair didn't run in this shard
+            shard_file.writeCell("result");
+            shard_file.writeCell(to_string(num_of_algo));
+            shard_file.writeCell(to_string(num_of_travel));
+            shard_file.writeCell(results.hasError(num_of_algo, num_of_travel) ? "1" : "0");
+            shard_file.writeCell(to_string(results.getNumOfOps(num_of_algo, num_of_travel)), true);
+            for (auto &err : errors[num_of_algo][num_of_travel]) {
+                shard_file.writeCell("error");
+                shard_file.writeCell(to_string(num_of_algo));
+                shard_file.writeCell(to_string(num_of_travel));
+                shard_file.writeCell(err, true);
+            }
         }
-        statistics[i].insert(statistics[i].end() - 1, pair(to_string(sum), 0));
     }
 }
 
-void Simulator::addNumErrColumn() {
-    auto num_of_algos = (int) statistics.size();
-    auto num_of_travels = (int) statistics[0].size() - 1;
-    int num_err;
-    for (int i = 1; i < num_of_algos; ++i) {
-        num_err = 0;
-        for (int j = 1; j < num_of_travels; ++j) {
-            if (statistics[i][j].second == -1) continue; // Ignore invalid travels
-            num_err += statistics[i][j].second;
+bool Simulator::readShardFile(const string &shard_dir, ShardRecord &record) {
+    std::ifstream shard_file(shard_dir + std::filesystem::path::preferred_separator + SHARD_FILE_NAME);
+    if (!shard_file.is_open())
+        return false;
+    string line, type;
+    vector<string> fields;
+    while (std::getline(shard_file, line)) {
+        type = line.substr(0, line.find(','));
+        // Indexes are checked against the algorithms and travels that were listed before them
+        auto validIndex = [](const string &index, const vector<string> &names) {
+            return isPositiveNumber(index) && string2int(index) >= 1 && string2int(index) <= (int) names.size();
+        };
+        auto validIndexes = [&record, &validIndex](const string &num_of_algo, const string &num_of_travel) {
+            return validIndex(num_of_algo, record.algos_names) && validIndex(num_of_travel, record.travels_names);
+        };
+        if (type == "shard" && splitShardLine(line, 3, fields) && isPositiveNumber(fields[1]) &&
+            isPositiveNumber(fields[2])) {
+            record.shard_index = string2int(fields[1]);
+            record.num_of_shards = string2int(fields[2]);
+        } else if (type == "algo" && splitShardLine(line, 2, fields)) {
+            record.algos_names.push_back(fields[1]);
+        } else if (type == "travel" && splitShardLine(line, 4, fields)) {
+            record.scanned_travels.push_back(fields[1] == "1");
+            record.removed_travels.push_back(fields[2] == "1");
+            record.travels_names.push_back(fields[3]);
+            record.travels_errs.emplace_back();
+        } else if (type == "general" && splitShardLine(line, 2, fields)) {
+            record.general_errs.push_back(fields[1]);
+        } else if (type == "travel_error" && splitShardLine(line, 3, fields) &&
+                   validIndex(fields[1], record.travels_names)) {
+            record.travels_errs[string2int(fields[1]) - 1].push_back(fields[2]);
+        } else if (type == "result" && splitShardLine(line, 5, fields) && validIndexes(fields[1], fields[2])) {
+            record.results.emplace_back(string2int(fields[1]), string2int(fields[2]), fields[4], fields[3] == "1");
+        } else if (type == "error" && splitShardLine(line, 4, fields) && validIndexes(fields[1], fields[2])) {
+            record.pairs_errs.emplace_back(string2int(fields[1]), string2int(fields[2]), fields[3]);
+        } else {
+            return false; // Broken shard file
         }
-        statistics[i].emplace_back(to_string(num_err), 0);
     }
+    return record.num_of_shards > 0;
 }
 
-void Simulator::sortResults() {
-    sort(statistics.begin(), statistics.end(), [](vector<pair<string, int>> &v1, vector<pair<string, int>> &v2) {
-        if (v1[0].first == "RESULTS") // Title row, always first
-            return true;
-        if (v2[0].first == "RESULTS") // Title row, always first
+bool Simulator::mergeShard(const ShardRecord &record, vector<bool> &merged_travels) {
+    // The shard's algorithms and travels may be listed in a different order, they are matched by their names
+    map<string, int> algos_nums, travels_nums;
+    for (int num_of_algo = 1; num_of_algo <= (int) inst.algo_funcs.size(); ++num_of_algo) {
+        algos_nums[inst.algo_funcs[num_of_algo - 1].first] = num_of_algo;
+    }
+    for (int num_of_travel = 1; num_of_travel <= (int) travel_directories.size(); ++num_of_travel) {
+        travels_nums[travel_directories[num_of_travel - 1].string()] = num_of_travel;
+    }
+    if (record.algos_names.size() != algos_nums.size() || record.travels_names.size() != travels_nums.size())
+        return false;
+    vector<int> algos_map(record.algos_names.size()), travels_map(record.travels_names.size());
+    for (int i = 0; i < (int) record.algos_names.size(); ++i) {
+        if (algos_nums.find(record.algos_names[i]) == algos_nums.end())
             return false;
-        int v1_errors = stoi(v1[(int) v1.size() - 1].first);
-        int v2_errors = stoi(v2[(int) v2.size() - 1].first);
-        if (v1_errors != v2_errors) // Sort by number of errors, if there is difference
-            return v1_errors < v2_errors;
-        // Sort by sum of actions in case of errors tie
-        return stoi(v1[(int) v1.size() - 2].first) < stoi(v2[(int) v2.size() - 2].first);
-    });
+        algos_map[i] = algos_nums[record.algos_names[i]];
+    }
+    for (int i = 0; i < (int) record.travels_names.size(); ++i) {
+        if (travels_nums.find(record.travels_names[i]) == travels_nums.end())
+            return false;
+        travels_map[i] = travels_nums[record.travels_names[i]];
+    }
+    for (int i = 0; i < (int) record.travels_names.size(); ++i) {
+        int num_of_travel = travels_map[i];
+        if (!record.scanned_travels[i] || merged_travels[num_of_travel - 1])
+            continue; // The travel's general errors are taken from the first shard that scanned it
+        merged_travels[num_of_travel - 1] = true;
+        travels_errors[num_of_travel - 1] = record.travels_errs[i];
+        if (record.removed_travels[i])
+            markRemovedTravel(num_of_travel);
+    }
+    for (auto &result : record.results) {
+        insertResult(algos_map[std::get<0>(result) - 1], travels_map[std::get<1>(result) - 1], std::get<2>(result),
+                     std::get<3>(result));
+    }
+    for (auto &err : record.pairs_errs) {
+        insertError(algos_map[std::get<0>(err) - 1], travels_map[std::get<1>(err) - 1], std::get<2>(err));
+    }
+    return true;
 }
 
-void Simulator::createResultsFile() {
-    FileHandler res_file(this->output_dir_path + std::filesystem::path::preferred_separator + "simulation.results",
-                         true);
-    if (res_file.isFailed()) {
-        return;
+bool Simulator::mergeShards(const vector<string> &shards_dirs) {
+    string algorithm_path; // Not used by the merge
+    if (!updateInput(algorithm_path)) {
+        fillSimErrors();
+        err_occurred = true;
+        return false;
     }
-    addNumErrColumn();
-    addSumColumn();
-    sortResults();
-    auto rows = (int) statistics.size();
-    auto cols = (int) statistics[0].size();
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            if (j == cols - 1) { // in case we are in the last cell
-                // Skip the travel data if it got skipped
-                (statistics[i][j].second != -1) ? res_file.writeCell(statistics[i][j].first, true) : res_file.writeCell(
-                        "", true);
-            } else if (statistics[i][j].second != -1) res_file.writeCell(statistics[i][j].first);
+    vector<ShardRecord> records(shards_dirs.size());
+    for (int i = 0; i < (int) shards_dirs.size(); ++i) {
+        if (!readShardFile(shards_dirs[i], records[i])) {
+            errors[0][0].push_back("@ FATAL ERROR: Can't read the shard file in " + shards_dirs[i] + ".");
+            fillSimErrors();
+            err_occurred = true;
+            return false;
+        }
+    }
+    // All of the shards of the same run must be given, each one of them once
+    int num_of_shards = records[0].num_of_shards;
+    vector<bool> seen_shards(num_of_shards, false);
+    for (auto &record : records) {
+        if (record.num_of_shards != num_of_shards || record.shard_index >= num_of_shards ||
+            seen_shards[record.shard_index]) {
+            errors[0][0].push_back("@ FATAL ERROR: The given shards are not the shards of a single run.");
+            fillSimErrors();
+            err_occurred = true;
+            return false;
         }
+        seen_shards[record.shard_index] = true;
     }
+    if ((int) records.size() != num_of_shards) {
+        errors[0][0].push_back("@ FATAL ERROR: Missing shards, " + to_string(records.size()) + " out of " +
+                               to_string(num_of_shards) + " were given.");
+        fillSimErrors();
+        err_occurred = true;
+        return false;
+    }
+
+    // The first shard sets the order of the algorithms and the travels, as the single run would
+    for (auto &algo_name : records[0].algos_names) {
+        inst.algo_funcs.emplace_back(algo_name, nullptr);
+    }
+    for (auto &travel_name : records[0].travels_names) {
+        travel_directories.emplace_back(travel_name);
+    }
+    initializeResAndErrs();
+    travels_errors.assign(travel_directories.size(), vector<string>());
+    errors[0][0].insert(errors[0][0].end(), records[0].general_errs.begin(), records[0].general_errs.end());
+    if (!records[0].general_errs.empty())
+        err_occurred = true;
+    vector<bool> merged_travels(travel_directories.size(), false);
+    for (int i = 0; i < (int) records.size(); ++i) {
+        if (!mergeShard(records[i], merged_travels)) {
+            errors[0][0].push_back("@ FATAL ERROR: The shard in " + shards_dirs[i] +
+                                   " doesn't have the same algorithms and travels as the other shards.");
+            fillSimErrors();
+            err_occurred = true;
+            return false;
+        }
+    }
+    mergeTravelsErrors();
+    inst.algo_funcs.clear();
+    inst.algo_extensions.clear();
+    createOutputFiles();
+    return true;
+}
+
+void Simulator::extractGeneralErrors(vector<pair<int, string>> &err_strings, const string &travel_name,
+                                     vector<string> &travel_errs) {
+    for (int i = 0; i < (int) err_strings.size(); ++i) {
+        travel_errs.push_back("@ Travel: " + travel_name + "- " + err_strings[i].second);
+    }
+    err_strings.clear(); // Clearing the errors list for future re-use.
+}
+
+void Simulator::createResultsFile() {
+    string dir = this->output_dir_path + std::filesystem::path::preferred_separator;
+    results.exportResults(dir + RESULTS_FILE_NAME);
+    results.writeFile(dir + STORE_FILE_NAME); // Can be queried and exported again without rerunning
+}
+
+bool Simulator::exportResultsStore(const string &store_dir) {
+    string algorithm_path; // Not used by the export
+    if (!updateInput(algorithm_path)) {
+        fillSimErrors();
+        err_occurred = true;
+        return false;
+    }
+    if (!results.map(store_dir + std::filesystem::path::preferred_separator + STORE_FILE_NAME)) {
+        errors[0][0].push_back("@ FATAL ERROR: Can't read the results store in " + store_dir + ".");
+        fillSimErrors();
+        err_occurred = true;
+        return false;
+    }
+    string dir = this->output_dir_path + std::filesystem::path::preferred_separator;
+    results.exportResults(dir + RESULTS_FILE_NAME);
+    results.exportRankings(dir + RANKINGS_FILE_NAME);
+    return true;
 }
 
 bool noErrorsDetected(vector<vector<string>> &errors) {
@@ -364,7 +1432,7 @@ void Simulator::fillSimErrors() {
 
 void Simulator::printSimulationResults() {
     cout << "Results File:" << endl;
-    printCSVFile(this->output_dir_path + std::filesystem::path::preferred_separator + "simulation.results");
+    printCSVFile(this->output_dir_path + std::filesystem::path::preferred_separator + RESULTS_FILE_NAME);
 }
 
 void Simulator::printSimulationErrors() {
@@ -374,11 +1442,7 @@ void Simulator::printSimulationErrors() {
         cout << "Couldn't open errors file." << endl;
 }
 
-void Simulator::insertResult(int num_of_algo, int num_of_travel, string num_of_op, bool err_in_travel) {
-    if (err_in_travel) {
-        statistics[num_of_algo][num_of_travel] = pair("-1", 1);
-    } else {
-        //cout << "Num_of_algo: "<< num_of_algo << " Num of travel: " << num_of_travel << " num of op" << num_of_op << endl;
-        statistics[num_of_algo][num_of_travel].first = num_of_op;
-    }
+void Simulator::insertResult(int num_of_algo, int num_of_travel, const string &num_of_op, bool err_in_travel) {
+    results.setResult(num_of_algo, num_of_travel, (!err_in_travel && isNumber(num_of_op)) ? std::stol(num_of_op) : -1,
+                      err_in_travel);
 }
\ No newline at end of file
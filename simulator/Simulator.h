@@ -2,81 +2,358 @@
 #define STOWAGEPROJECT_SIMULATOR_H
 
 #include <dlfcn.h>
+#include <limits>
+#include <tuple>
 #include "ThreadPool.h"
+#include "ProcessPool.h"
+#include "Watchdog.h"
+#include "ResultCell.h"
+#include "ResultsJournal.h"
+#include "ResultsStore.h"
+#include "ResultsCache.h"
 #include "Simulation.h"
 
 
 using std::to_string;
 
+class Simulation;
+struct TravelTemplate;
+
 /**
  * Simulator Class.
  *  Author: Shalev Drukman.
  *  The simulator is responsible for executing the travels and the algorithms matched together,
- *  using a multi-threading model that creates a thread for each travel-algorithm pair.
+ *  using a thread pool that scans the travels and runs a task for each travel-algorithm pair.
  *  Each thread is running a simulation instance that will report errors and statistics to the simulator.
  *  As a result, the simulator is responsible for reporting it to an organized file.
  */
 
+/**
+ * Settings of a single algorithm-travel pair, given by the manifest. They override the settings of the run.
+ */
+struct PairSettings {
+    int time_budget = -1; // Seconds the pair may run (0 if it's not limited), -1 to keep the run's budget
+    int pipelined_ports = -1; // 1 or 0 to run the pair pipelined or not, -1 to keep the run's setting
+};
+
+/**
+ * Optional behaviours of the simulator, set by command line flags.
+ */
+struct RunOptions {
+    bool pipelined_ports = false; // Each simulation runs the algorithm ahead of the validation, on another worker
+    bool lockstep = false; // A single task runs all of the algorithms on a travel together, port by port
+    int shard_index = 0; // Run only the algorithm-travel pairs of this shard (counted from 0)
+    int num_of_shards = 0; // Number of shards the pairs are partitioned to, 0 if the run is not sharded
+    bool worker_processes = false; // The simulations run in forked worker processes instead of threads
+    int time_budget = 0; // Seconds each simulation (and each travel's scan) may run, 0 if it's not limited
+    map<string, int> algos_time_budgets; // Algorithm's name -> seconds its simulations may run, instead of time_budget
+    int max_pair_errors = 0; // Errors listed for each algorithm-travel pair, the rest are summarized. 0 for no limit
+    map<pair<string, string>, PairSettings> manifest; // (algorithm, travel) -> settings. If given, only these pairs run
+    string cache_dir; // Folder of the cached pairs, which are not simulated again. Empty if the pairs are not cached
+    bool resume = false; // Go on with an interrupted run in its output folder, the pairs it has done are not run again
+    bool instruction_files = true; // Write the crane instructions files, otherwise they are only validated
+};
+
+/**
+ * Cost of a travel-algorithm pair, as recorded by a previous run.
+ */
+struct CostRecord {
+    long duration; // Running time in microseconds
+    long estimated_cost; // The estimation of the travel's cost
+};
+
+/**
+ * The content of a shard file, written by a sharded run and read by the merge mode.
+ */
+struct ShardRecord {
+    int shard_index = -1;
+    int num_of_shards = 0;
+    vector<string> algos_names; // By the shard's algorithms order
+    vector<string> travels_names; // By the shard's travels order
+    vector<bool> scanned_travels; // Travels that were scanned by the shard
+    vector<bool> removed_travels; // Scanned travels that had a fatal error
+    vector<string> general_errs; // General errors that are not related to a travel
+    vector<vector<string>> travels_errs; // General errors of each scanned travel
+    vector<std::tuple<int, int, string, bool>> results; // (algorithm, travel, num of operations, error occurred)
+    vector<std::tuple<int, int, string>> pairs_errs; // (algorithm, travel, error message)
+};
+
 //---Main class---//
 class Simulator {
 private:
     string output_dir_path;
     unsigned int number_of_threads;
+    RunOptions options;
     bool err_occurred;
-    string curr_travel_name;
 
-    static vector<vector<pair<string, int>>> statistics;
-    // Each cell in the 2D matrix saves a pair of (num_of_operation, error_detected) for an Algorithm-Travel pair.
+    static ResultsStore results;
+    // The number of operations, error detected, number of errors and running time of each Algorithm-Travel pair.
 
     static vector<vector<vector<string>>> errors;
     // Each cell in the 2D matrix saves a list of error messages for an Algorithm-Travel pair.
 
+    std::unique_ptr<ResultCell[]> result_cells; // The cell of each Algorithm-Travel pair, collected into the matrices
+    ResultsJournal journal; // The results of the pairs that are done, in the order they were done
+
+    map<pair<string, string>, CostRecord> cost_history; // (algorithm, travel) -> cost saved by the previous run
+    double history_scale = 0; // Converts running times of the history to the estimations units
+    vector<long> travels_estimates; // Estimated cost of each travel, indexed by the travel number - 1
+    vector<vector<string>> travels_errors; // General errors of each travel, indexed by the travel number - 1
+    vector<int> ingest_order; // Travels numbers in the order they are scanned
+    atomic_int next_travel_to_ingest{0}; // Index in ingest_order of the next travel to scan
+    std::unique_ptr<Watchdog> watchdog; // Enforces the time budgets of the simulations, if there are any
+    atomic_int abandoned_tasks{0}; // Tasks that were given up while stuck in an algorithm
+    vector<pair<int, int>> process_tasks; // (algorithm, travel) pairs of the worker processes, algorithm 0 only scans
+    vector<int> algos_ranks; // Position of each algorithm's name among the sorted names, used for sharding
+    vector<int> travels_ranks; // Position of each travel's name among the sorted names, used for sharding
+    vector<bool> manifest_pairs; // Whether each pair is listed in the manifest, empty if there is no manifest
+    ResultsCache cache; // Open if the run was given a cache folder
+    vector<uint64_t> algos_hashes; // Hash of each algorithm's shared object, if the pairs are cached
+    vector<uint64_t> travels_hashes; // Hash of each travel's files, set once it's scanned, if the pairs are cached
+    vector<bool> resumed_pairs; // Whether each pair was done by the interrupted run, empty if the run isn't resumed
+
     static Simulator inst;
     vector<pair<string, std::function<std::unique_ptr<AbstractAlgorithm>()>>> algo_funcs;
+    vector<unsigned int> algo_extensions; // The AlgorithmExtension flags each algorithm of algo_funcs registered with
     vector<void *> handlers;
     vector<std::filesystem::path> travel_directories;
 
     /**
-     * Get all of the travel directories paths.
+     * Get all of the travel directories paths. Travels that the manifest (if given) doesn't list are kept as columns of
+     * the results, they are not scanned.
      */
     bool loadTravelsPaths(string &travels_dir_path);
 
     /**
-     * Loads all the algorithms constructors into the simulator instance list.
+     * Loads all the algorithms constructors into the simulator instance list. Algorithms that the manifest (if given)
+     * doesn't list are kept as rows of the results without a constructor, they are not loaded.
      */
     void loadAlgorithms(string &algorithm_path);
 
     /**
-     * Iterates over the given travel folder and initializes the ship plan and the route.
+     * Iterates over the given travel folder and initializes the ship plan and the route of @param scanned_travel.
+     * General errors of the travel are added to @param travel_errs.
+     * The ports containers files are parsed in parallel on the given pool.
      */
-    bool scanTravelDir(ShipPlan &ship, Route &travel, string &plan_path, string &route_path,
-                       const std::filesystem::path &travel_dir);
+    bool scanTravelDir(TravelTemplate &scanned_travel, string &plan_path, string &route_path,
+                       const std::filesystem::path &travel_dir, const string &travel_name,
+                       vector<string> &travel_errs, ThreadPool &thread_pool);
 
     /**
-     * Updating algorithm and output path to be the curret folder if they are missing.
+     * Starts the ingestion stage: a few tasks in the pool scan the travels, from the biggest one to the smallest.
      */
-    bool updateInput(string &algorithm_path);
+    void ingestTravels(ThreadPool &thread_pool, WeightBalanceCalculator &calc);
 
     /**
-     * Sort the results, first appears algorithms with lowest number of errors, and in case errors number
-     * is even sort by sum of actions that the algorithm done
+     * Scans the next travel that wasn't taken yet, then gives the pool a task to scan the one after it.
      */
-    void sortResults();
+    void ingestNextTravel(ThreadPool &thread_pool, WeightBalanceCalculator &calc);
 
     /**
-     * Creating a results file containing the number of operations performed in each travel for each algorithm.
+     * Scans the given travel and gives the pool its simulations, one for each algorithm.
      */
-    void createResultsFile();
+    void ingestTravel(int num_of_travel, ThreadPool &thread_pool, WeightBalanceCalculator &calc);
+
+    /**
+     * Scans the given travel into a template for its simulations, returns nullptr if it has a fatal error.
+     * Records the travel's estimated cost as well.
+     */
+    std::shared_ptr<const TravelTemplate> scanTravel(int num_of_travel, ThreadPool &thread_pool, string &plan_path,
+                                                     string &route_path);
+
+    /**
+     * Orders the travels by the size of their folders, from the biggest one to the smallest, into ingest_order.
+     */
+    void orderTravelsBySize();
+
+    /**
+     * A travel that was scanned by a worker process, kept for the next pairs of the same travel.
+     */
+    struct WorkerTravel {
+        int num_of_travel = 0;
+        std::shared_ptr<const TravelTemplate> travel_template; // nullptr if the travel had a fatal error
+        string plan_path;
+        string route_path;
+    };
+
+    /**
+     * Runs all of the pairs in forked worker processes, a crashing pair is reported as an error of that pair.
+     * Returns false if the worker processes can't be used, nothing was run in that case.
+     */
+    bool runInWorkerProcesses(WeightBalanceCalculator &calc);
+
+    /**
+     * Runs a single task in a worker process and writes its results and errors to the task's shared memory slot.
+     */
+    void runProcessTask(int task, WorkerTravel &worker_travel, WeightBalanceCalculator &calc, char *slot,
+                        size_t slot_size);
+
+    /**
+     * Adds the results and the errors of a task that a worker process wrote to its slot to the matrices.
+     */
+    void collectProcessTask(int task, const char *slot, vector<bool> &merged_travels);
 
     /**
-     * Calculating the sum of the operations and write it to the result file.
+     * Returns the settings the manifest gives the pair, or nullptr if it gives none.
      */
-    void addSumColumn();
+    const PairSettings *getPairSettings(int num_of_algo, int num_of_travel) const;
 
     /**
-     * calculating the number of errors performed by an algorithm and write it to the result file.
+     * Returns the time budget of the given pair's simulation, in seconds (0 if it's not limited).
      */
-    void addNumErrColumn();
+    int getTimeBudget(int num_of_algo, int num_of_travel) const;
+
+    /**
+     * Returns true if the given pair's simulation runs the algorithm ahead of the validation.
+     */
+    bool isPipelined(int num_of_algo, int num_of_travel) const;
+
+    bool hasTimeBudgets() const {
+        if (options.time_budget > 0)
+            return true;
+        for (auto &algo_budget : options.algos_time_budgets) {
+            if (algo_budget.second > 0)
+                return true;
+        }
+        for (auto &pair_settings : options.manifest) {
+            if (pair_settings.second.time_budget > 0)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Runs a task of the given simulations and journals their results once they are done.
+     * With time budgets, each simulation is cancelled once its own running time is over its budget, and if the task
+     * runs longer than all of its budgets and the grace period, the simulations are reported as timed out and the
+     * worker is given up.
+     */
+    void runTask(ThreadPool &thread_pool, const vector<std::shared_ptr<Simulation>> &sims,
+                 const std::function<void()> &run);
+
+    /**
+     * Creates the journal and the status file in the output folder, for the pairs of this run. The pairs that were
+     * resumed are journaled right away. Returns false if the journal can't be written.
+     */
+    bool openJournal();
+
+    /**
+     * Returns the journal records of a pair that its cell is done (or was given up), ended by a done record.
+     */
+    string getPairRecords(int num_of_algo, int num_of_travel);
+
+    /**
+     * Appends the result cell of a pair that is done (or was given up) to the journal.
+     */
+    void journalPair(int num_of_algo, int num_of_travel);
+
+    /**
+     * Appends the results and the errors of a task that a worker process wrote to its slot to the journal.
+     */
+    void journalProcessTask(int task, const char *slot);
+
+    /**
+     * Reads the pairs that the interrupted run has done from the journal in the output folder into their result
+     * cells, so they are not run again. A pair that its records were not all written is run again.
+     */
+    void resumeJournal();
+
+    bool isPairResumed(int num_of_algo, int num_of_travel) const {
+        return !resumed_pairs.empty() &&
+               resumed_pairs[(size_t) (num_of_algo - 1) * travel_directories.size() + (num_of_travel - 1)];
+    }
+
+    /**
+     * Adds the results and the errors in the journal to the matrices, returns false if it can't be read.
+     */
+    bool readJournal();
+
+    /**
+     * Returns the key of the pair in the cache, by the hashes of its algorithm and its travel.
+     */
+    string getCacheKey(int num_of_algo, int num_of_travel) const;
+
+    /**
+     * Fills the result cell of a pair that is done with the given outcome, which its errors were already formatted.
+     */
+    static void fillDoneCell(ResultCell &cell, const ResultsCache::Entry &outcome);
+
+    /**
+     * Fills the pair's result cell from the cache and copies its crane instructions to the output folder, returns
+     * false if the pair isn't cached (or the pairs are not cached at all).
+     */
+    bool loadFromCache(int num_of_algo, int num_of_travel);
+
+    /**
+     * Adds the pair's result cell and its crane instructions to the cache, if the pairs are cached.
+     * Called once the pair's simulation is done, unless it was cancelled.
+     */
+    void storeInCache(int num_of_algo, int num_of_travel);
+
+    /**
+     * Returns the timeout error of a task that its worker process was killed, by the progress found in its slot.
+     */
+    string timedOutProcessMessage(int task, const char *slot);
+
+    /**
+     * Runs the given simulations of the same travel together: each port is executed by all of them before the ship
+     * moves to the next one, so they work on the same port's data at the same time.
+     */
+    static void runLockstep(vector<std::shared_ptr<Simulation>> &sims);
+
+    /**
+     * Ranks the algorithms and the travels by their names, so the shards partition the pairs the same way
+     * regardless of the order the files are listed in. Marks the pairs that are listed in the manifest as well.
+     */
+    void initShardRanks();
+
+    /**
+     * Returns true if the algorithm-travel pair should run in this shard (and it's listed in the manifest, if given).
+     */
+    bool isPairInShard(int num_of_algo, int num_of_travel) const;
+
+    /**
+     * Returns true if this shard should scan the given travel (it runs at least one of the travel's pairs).
+     */
+    bool isTravelInShard(int num_of_travel) const;
+
+    /**
+     * Writes everything the merge mode needs about this shard's results and errors to the shard file.
+     * Called before the travels general errors are merged.
+     */
+    void writeShardFile();
+
+    /**
+     * Reads the shard file in the given folder into @param record, returns false if it can't be read.
+     */
+    static bool readShardFile(const string &shard_dir, ShardRecord &record);
+
+    /**
+     * Adds the results and the errors of the given shard to the matrices, returns false if the shard doesn't
+     * match the first one.
+     */
+    bool mergeShard(const ShardRecord &record, vector<bool> &merged_travels);
+
+    /**
+     * Creates the results file and the errors file (if there are general errors) out of the matrices.
+     */
+    void createOutputFiles();
+
+    /**
+     * Merging the general errors of all of the travels with the errors member, by the travels order.
+     */
+    void mergeTravelsErrors();
+
+    /**
+     * Updating algorithm and output path to be the curret folder if they are missing.
+     */
+    bool updateInput(string &algorithm_path);
+
+    /**
+     * Creating a results file containing the number of operations performed in each travel for each algorithm,
+     * sorted by the number of errors and then by the sum of the operations. The results store is saved beside it.
+     */
+    void createResultsFile();
 
     /**
      * Creating an errors file containing the errors description that occured during the simulation.
@@ -89,20 +366,57 @@ private:
     bool validateAlgoLoad(void *handler, string &algo_name, int prev_size);
 
     /**
-     * Initialize the statistics matrix and the errors matrix (for Travel-Algorithm pair).
+     * Initialize the results store and the errors matrix (for Travel-Algorithm pair).
      */
     void initializeResAndErrs();
 
     /**
-     * Merging given errors with the errors member.
+     * Merging given errors with the general errors of the travel.
+     */
+    void extractGeneralErrors(vector<pair<int, string>> &err_strings, const string &travel_name,
+                              vector<string> &travel_errs);
+
+    ResultCell &getResultCell(int num_of_algo, int num_of_travel) {
+        return result_cells[(num_of_algo - 1) * travel_directories.size() + (num_of_travel - 1)];
+    }
+
+    /**
+     * Formats the error records of a cell that is done to their messages, followed by a summary of each kind of
+     * errors that were left out.
+     */
+    vector<string> formatCellErrors(const ResultCell &cell, int num_of_travel) const;
+
+    /**
+     * Copies the result cells of the simulations that ran into the results. Called once the tasks are done.
      */
-    void extractGeneralErrors(vector<pair<int, string>> &err_strings);
+    void collectResultCells();
 
     /**
-     * Mark an invalid travel in the results matrix (will be ignored later).
+     * Mark an invalid travel in the results (will be ignored later).
      */
     void markRemovedTravel(int num_of_travel);
 
+    /**
+     * Estimates the cost of simulating the given travel, using the ship size, the route length and the cargo amount.
+     */
+    static long estimateTravelCost(ShipPlan &ship, Route &travel);
+
+    /**
+     * Loads the running times of the previous run from the history file in the output folder.
+     */
+    void loadCostHistory();
+
+    /**
+     * Saves the running times of this run (and the unchanged ones of the previous run) to the history file.
+     */
+    void saveCostHistory();
+
+    /**
+     * Returns the cost of a travel-algorithm pair: its scaled running time from the previous run if there is one,
+     * otherwise the travel's estimated cost.
+     */
+    double getTaskCost(const string &algo_name, const string &travel_name, long estimated_cost);
+
     /**
      * Detects if any error occurred during the simulation.
      */
@@ -110,7 +424,8 @@ private:
 
 public:
     //---Constructors and Destructors---//
-    explicit Simulator(const string &output_path, unsigned int number_of_threads);
+    explicit Simulator(const string &output_path, unsigned int number_of_threads,
+                       const RunOptions &options = RunOptions());
 
     Simulator() = default;
 
@@ -118,8 +433,18 @@ public:
         return inst;
     }
 
-    void registerAlgorithm(std::function<std::unique_ptr<AbstractAlgorithm>()> algo_ctor) {
+    void registerAlgorithm(std::function<std::unique_ptr<AbstractAlgorithm>()> algo_ctor,
+                           unsigned int extensions = NO_EXTENSIONS) {
         algo_funcs.emplace_back("", algo_ctor);
+        algo_extensions.push_back(extensions);
+    }
+
+    /**
+     * Whether the algorithm registered with the given extension (an AlgorithmExtension flag).
+     */
+    bool hasExtension(int num_of_algo, unsigned int extension) const {
+        return num_of_algo >= 1 && num_of_algo <= (int) algo_extensions.size() &&
+               (algo_extensions[num_of_algo - 1] & extension);
     }
 
     /**
@@ -127,11 +452,36 @@ public:
      */
     bool start(string algorithm_path, string output_path);
 
+    /**
+     * Merges the shard files of sharded runs in the given folders into the results and errors files that a single
+     * run would have created.
+     */
+    bool mergeShards(const vector<string> &shards_dirs);
+
+    /**
+     * Exports the results file and the rankings file from the results store of a previous run in the given folder,
+     * without running anything.
+     */
+    bool exportResultsStore(const string &store_dir);
+
+    // The simulations write to their own result cells, the results are changed only by the simulator's thread
     static void insertError(int num_of_algo, int num_of_travel, string err_msg) {
         errors[num_of_algo][num_of_travel].push_back(err_msg);
+        results.addError(num_of_algo, num_of_travel);
     }
 
-    static void insertResult(int num_of_algo, int num_of_travel, string num_of_op, bool err_in_travel);
+    static void insertResult(int num_of_algo, int num_of_travel, const string &num_of_op, bool err_in_travel);
+
+    static void insertDuration(int num_of_algo, int num_of_travel, long duration) {
+        results.setDuration(num_of_algo, num_of_travel, duration);
+    }
+
+    /**
+     * Returns true if some of the simulations were given up while stuck, their threads may still be running.
+     */
+    bool hasAbandonedTasks() const {
+        return abandoned_tasks > 0;
+    }
 
     /**
      * Prints the simulation results.
@@ -1,40 +1,150 @@
 #include "ThreadPool.h"
 
-ThreadPool::ThreadPool(int numOfThreads) : numOfThreads(numOfThreads) {
-    workers.reserve(numOfThreads);
+ThreadPool::ThreadPool(int numOfThreads, bool callerRunsTasks)
+        : numOfThreads(numOfThreads < 1 ? 1 : numOfThreads), callerRunsTasks(callerRunsTasks) {
+    workers.reserve(this->numOfThreads - 1);
+    for(int i = 0; i < this->numOfThreads; i++){
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+void ThreadPool::addTask(std::function<void()> func, double cost) {
+    WorkerQueue &queue = *queues[nextQueue++ % numOfThreads];
+    activeTasks++;
+    {
+        std::lock_guard<mutex> lock(queue.queueMutex);
+        queue.tasks.push_back(Task{std::move(func), cost, queue.nextOrder++});
+        std::push_heap(queue.tasks.begin(), queue.tasks.end(), runsAfter);
+    }
+    {
+        std::lock_guard<mutex> lock(parkMutex);
+        pendingTasks++;
+    }
+    parkCond.notify_one();
+}
+
+void ThreadPool::JobsGroup::claimJobs() {
+    int job;
+    while((job = nextJob++) < (int) jobs.size()) {
+        jobs[job]();
+        if(++doneJobs == (int) jobs.size()) {
+            std::lock_guard<mutex> lock(doneMutex);
+            doneCond.notify_all();
+        }
+    }
 }
 
-void ThreadPool::getTask(Simulation& sim) {
-    tasks.emplace(std::move(sim));
+void ThreadPool::runJobs(vector<std::function<void()>> &jobs, double cost) {
+    if(numOfThreads == 1 || jobs.size() < 2) {
+        for(auto& job : jobs)
+            job();
+        return;
+    }
+    auto group = std::make_shared<JobsGroup>();
+    group->jobs = std::move(jobs);
+    int numOfHelpers = std::min(numOfThreads, (int) group->jobs.size()) - 1;
+    for(int i = 0; i < numOfHelpers; i++){
+        addTask([group] { group->claimJobs(); }, cost);
+    }
+    group->claimJobs();
+    // All of the jobs were claimed, wait for the ones that other threads are still running
+    std::unique_lock<mutex> lock(group->doneMutex);
+    group->doneCond.wait(lock, [&group] { return group->doneJobs == (int) group->jobs.size(); });
+}
+
+void ThreadPool::spawnWorker(int id) {
+    auto worker = std::make_shared<WorkerState>();
+    worker->id = id;
+    workers.emplace_back(thread([this, worker] {workerFunc(worker);}), worker);
 }
 
 void ThreadPool::start() {
-    for(int i = 0; i < numOfThreads; i++){
-        workers.emplace_back([this] {workerFunc();});
+    std::lock_guard<mutex> lock(parkMutex);
+    // Queue 0 is served by the thread that calls finish(), or by a worker of its own if the caller only waits
+    for(int i = callerRunsTasks ? 1 : 0; i < numOfThreads; i++){
+        spawnWorker(i);
+    }
+}
+
+void ThreadPool::abandonWorker(const std::shared_ptr<WorkerState> &worker) {
+    if(!worker || worker->abandoned.exchange(true))
+        return;
+    abandonedWorkers++;
+    {
+        std::lock_guard<mutex> lock(parkMutex);
+        spawnWorker(worker->id); // Serves the stuck worker's queue from now on
+    }
+    taskDone(); // The stuck task won't call it
+}
+
+bool ThreadPool::popTask(int id, Task &task) {
+    WorkerQueue &queue = *queues[id];
+    std::lock_guard<mutex> lock(queue.queueMutex);
+    if(queue.tasks.empty())
+        return false;
+    std::pop_heap(queue.tasks.begin(), queue.tasks.end(), runsAfter);
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    pendingTasks--;
+    return true;
+}
+
+bool ThreadPool::stealTask(int id, Task &task) {
+    for(int i = 1; i < numOfThreads; i++){
+        if(popTask((id + i) % numOfThreads, task))
+            return true;
     }
+    return false;
 }
 
-void ThreadPool::workerFunc() {
-    while(!finished || !tasks.empty()){
-        if(tasks.empty()){
-            std::this_thread::yield(); // No task right now, yield and check once get cpu again
+void ThreadPool::taskDone() {
+    if(--activeTasks == 0) {
+        std::lock_guard<mutex> lock(parkMutex);
+        parkCond.notify_all();
+    }
+}
+
+void ThreadPool::workerFunc(const std::shared_ptr<WorkerState> &worker) {
+    currentWorker = worker;
+    int id = worker->id;
+    Task task;
+    while(true){
+        if(popTask(id, task) || stealTask(id, task)) {
+            task.func();
+            if(worker->abandoned)
+                return; // Another thread took this one's place while the task was stuck, the pool may be gone
+            task.func = nullptr; // Release the task's resources before parking
+            taskDone();
             continue;
         }
-        tasksMutex.lock();
-        if(!tasks.empty()) {
-            Simulation sim = tasks.front();
-            tasks.pop();
-            tasksMutex.unlock();
-            sim.runSimulation();
-        } else {
-            tasksMutex.unlock();
-        }
+        std::unique_lock<mutex> lock(parkMutex);
+        // No task right now, park until a new task is given or all of the tasks are done
+        parkCond.wait(lock, [this] { return pendingTasks > 0 || (finished && activeTasks == 0); });
+        if(finished && activeTasks == 0)
+            return;
     }
 }
 
 void ThreadPool::finish() {
-    finished = true;
+    {
+        std::lock_guard<mutex> lock(parkMutex);
+        finished = true;
+    }
+    parkCond.notify_all();
+    if(callerRunsTasks) {
+        auto worker = std::make_shared<WorkerState>();
+        worker->id = 0;
+        workerFunc(worker);
+        currentWorker = nullptr;
+    } else {
+        std::unique_lock<mutex> lock(parkMutex);
+        parkCond.wait(lock, [this] { return activeTasks == 0; });
+    }
+    // No worker is given up once all of the tasks are done, so the workers list doesn't change anymore
     for(auto& worker : workers) {
-        worker.join();
+        if(worker.second->abandoned)
+            worker.first.detach(); // Still stuck, left behind
+        else
+            worker.first.join();
     }
-}
\ No newline at end of file
+}
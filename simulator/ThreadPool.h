@@ -1,55 +1,161 @@
 /**
  * Created by Tomer Yoeli
  * The thread pool class, handle all of the threads actions.
- * In charge of collecting <algorithm, travel> tasks and run them in multiple threads.
+ * In charge of collecting tasks (simulations of <algorithm, travel> pairs, travels scanning) and run them in
+ * multiple threads. Tasks are ordered by their cost, the most expensive one runs first.
+ * Each worker owns a tasks queue, a worker that runs out of tasks steals from the other queues,
+ * and parks on a condition variable when there is nothing to steal.
+ * The thread that calls finish() joins the work as a worker as well, unless the tasks may get stuck: a worker that
+ * is stuck in a task can be given up, another thread takes its place and the stuck one is left behind.
  */
 
 #ifndef SHIPPROJECT_THREADPOOL_H
 #define SHIPPROJECT_THREADPOOL_H
 
-class Simulation;
-
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
 #include <vector>
-#include <queue>
-#include "Simulation.h"
+#include <algorithm>
+#include <memory>
+#include <utility>
 
 using std::thread;
 using std::vector;
-using std::queue;
 using std::atomic_int;
 using std::mutex;
+using std::condition_variable;
+using std::unique_ptr;
+using std::pair;
 
 class ThreadPool {
+public:
+    // State of a single worker thread, kept alive by the thread itself even if the pool is gone
+    struct WorkerState {
+        int id; // The worker's queue
+        std::atomic_bool abandoned{false}; // The worker is stuck in a task, another thread took its place
+    };
+
 private:
-    int numOfThreads;
-    vector<thread> workers;
-    queue<Simulation> tasks;
-    mutex tasksMutex;
-    bool finished = false;
+    struct Task {
+        std::function<void()> func;
+        double cost;
+        long order; // Tasks of the same cost are taken by the order they were given
+    };
+
+    /**
+     * Orders the tasks of a queue's heap: the most expensive task is on top, and the first given one on a tie.
+     */
+    static bool runsAfter(const Task &task1, const Task &task2) {
+        return task1.cost != task2.cost ? task1.cost < task2.cost : task1.order > task2.order;
+    }
+
+    // Tasks queue of a single worker, a heap by cost (see runsAfter) guarded by its own mutex
+    struct WorkerQueue {
+        vector<Task> tasks;
+        long nextOrder = 0;
+        mutex queueMutex;
+    };
+
+    // Jobs of a single runJobs() call, claimed one by one by the calling thread and by its helper tasks
+    struct JobsGroup {
+        vector<std::function<void()>> jobs;
+        atomic_int nextJob{0};
+        atomic_int doneJobs{0};
+        mutex doneMutex;
+        condition_variable doneCond;
+
+        /**
+         * Run jobs that were not claimed yet, until there are no more jobs to claim
+         */
+        void claimJobs();
+    };
+
+    int numOfThreads; // Total number of threads, including the one that calls finish()
+    bool callerRunsTasks; // False if the thread that calls finish() only waits for the workers
+    vector<pair<thread, std::shared_ptr<WorkerState>>> workers; // Guarded by parkMutex once the pool started
+    inline static thread_local std::shared_ptr<WorkerState> currentWorker; // The state of the calling worker thread
+    vector<unique_ptr<WorkerQueue>> queues; // queues[0] belongs to the thread that calls finish()
+    atomic_int nextQueue{0}; // Round robin index for new tasks
+    atomic_int pendingTasks{0}; // Number of tasks that were given and were not taken yet by any worker
+    atomic_int activeTasks{0}; // Number of tasks that were given and were not done yet (running tasks may add more)
+    mutex parkMutex;
+    condition_variable parkCond;
+    bool finished = false; // Guarded by parkMutex
+    atomic_int abandonedWorkers{0};
+
+    /**
+     * Pop the next task from the queue of worker @param id
+     */
+    bool popTask(int id, Task &task);
+
+    /**
+     * Steal a task from the queue of any other worker than @param id
+     */
+    bool stealTask(int id, Task &task);
+
+    /**
+     * Mark a task as done, wake up the parked workers if it was the last one.
+     */
+    void taskDone();
+
+    /**
+     * Create a worker thread that serves the queue of worker @param id, must be called while holding parkMutex.
+     */
+    void spawnWorker(int id);
 
 public:
-    explicit ThreadPool(int numOfThreads);
+    explicit ThreadPool(int numOfThreads, bool callerRunsTasks = true);
+
+    /**
+     * A handle of the worker thread that calls it (nullptr if it's not a worker of a pool), to give up on it later.
+     */
+    static std::shared_ptr<WorkerState> getCurrentWorker() {
+        return currentWorker;
+    }
+
+    /**
+     * Give up on a worker that is stuck in its current task: the task counts as done and a new thread takes the
+     * worker's place. If the task ever returns, the stuck thread ends.
+     * The thread that calls finish() can't be given up, so the pool must not be created with callerRunsTasks.
+     */
+    void abandonWorker(const std::shared_ptr<WorkerState> &worker);
+
+    /**
+     * Returns the number of workers that were given up.
+     */
+    int getNumOfAbandonedWorkers() const {
+        return abandonedWorkers;
+    }
+
+    /**
+     * Get new task, tasks with higher @param cost are taken first. may be called from a running task as well
+     */
+    void addTask(std::function<void()> func, double cost = 0);
 
     /**
-     * Get new task (Simulation object)
+     * Run all of the given jobs and return once they are all done. the jobs are shared with helper tasks of the
+     * given @param cost, and the calling thread runs jobs as well, so it may be called from a running task.
      */
-    void getTask(Simulation& sim);
+    void runJobs(vector<std::function<void()>> &jobs, double cost = 0);
 
     /**
-     * Start the threadPool, create all of the threads
+     * Start the threadPool, create all of the threads (except the one that calls finish())
      */
     void start();
 
     /**
-     * A single thread function. get task from the tasks vector and run it, until no more tasks left
+     * A single thread function. get task from the worker's queue or steal one and run it,
+     * park while there are no tasks, until finish() was called and all of the tasks are done
      */
-    void workerFunc();
+    void workerFunc(const std::shared_ptr<WorkerState> &worker);
 
     /**
-     * Finish the threadPool. no more tasks will be given. also wait until all of the threads will done (using join)
+     * Finish the threadPool. no more tasks will be given from outside the pool. the calling thread runs tasks as
+     * well (if callerRunsTasks) until all of them are done, then waits for all of the threads (using join),
+     * except for the ones that were given up
      */
     void finish();
 
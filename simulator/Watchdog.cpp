@@ -0,0 +1,55 @@
+#include "Watchdog.h"
+#include <algorithm>
+
+Watchdog::Watchdog(Clock::duration grace) : grace(grace) {
+    watcher = std::thread([this] { watchFunc(); });
+}
+
+Watchdog::~Watchdog() {
+    {
+        std::lock_guard<mutex> lock(entriesMutex);
+        stopping = true;
+    }
+    entriesCond.notify_all();
+    watcher.join();
+}
+
+int Watchdog::watch(Clock::duration budget, std::function<void()> onDeadline, std::function<void()> onAbandon) {
+    std::lock_guard<mutex> lock(entriesMutex);
+    int entry = nextEntry++;
+    entries[entry] = Entry{Clock::now() + budget, std::move(onDeadline), std::move(onAbandon)};
+    entriesCond.notify_all(); // The new deadline may be the nearest one
+    return entry;
+}
+
+void Watchdog::unwatch(int entry) {
+    std::lock_guard<mutex> lock(entriesMutex);
+    entries.erase(entry);
+}
+
+void Watchdog::watchFunc() {
+    std::unique_lock<mutex> lock(entriesMutex);
+    while (!stopping) {
+        auto now = Clock::now();
+        auto wakeUp = Clock::time_point::max();
+        for (auto it = entries.begin(); it != entries.end();) {
+            Entry &entry = it->second;
+            if (!entry.expired && now >= entry.deadline) {
+                entry.expired = true;
+                entry.onDeadline();
+            }
+            if (entry.expired && now >= entry.deadline + grace) {
+                entry.onAbandon();
+                it = entries.erase(it);
+                continue;
+            }
+            wakeUp = std::min(wakeUp, entry.expired ? entry.deadline + grace : entry.deadline);
+            ++it;
+        }
+        // The callbacks are called while holding the lock, so a task can't unwatch itself in the middle of them
+        if (wakeUp == Clock::time_point::max())
+            entriesCond.wait(lock);
+        else
+            entriesCond.wait_until(lock, wakeUp);
+    }
+}
@@ -0,0 +1,66 @@
+/**
+ * The watchdog class, enforces the time budgets of running tasks from a thread of its own.
+ * A watched task that runs over its budget is asked to stop (cooperatively, the task checks for it), and if it still
+ * runs after a grace period it is given up, since a task that is stuck in an algorithm's code can't be stopped.
+ */
+
+#ifndef SHIPPROJECT_WATCHDOG_H
+#define SHIPPROJECT_WATCHDOG_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <map>
+
+using std::mutex;
+using std::condition_variable;
+
+class Watchdog {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        std::function<void()> onDeadline; // Called once the budget is over
+        std::function<void()> onAbandon; // Called if the task still runs after the grace period as well
+        bool expired = false;
+    };
+
+    Clock::duration grace;
+    std::map<int, Entry> entries; // Watched tasks by their watch number
+    int nextEntry = 0;
+    mutex entriesMutex;
+    condition_variable entriesCond;
+    std::thread watcher;
+    bool stopping = false; // Guarded by entriesMutex
+
+    /**
+     * The watchdog's thread function, wakes up at the nearest deadline and handles the tasks that passed it.
+     */
+    void watchFunc();
+
+public:
+    explicit Watchdog(Clock::duration grace);
+
+    Watchdog(const Watchdog &other) = delete;
+
+    Watchdog &operator=(const Watchdog &other) = delete;
+
+    ~Watchdog();
+
+    /**
+     * Start watching a task that may run for @param budget, returns the watch number to unwatch it with.
+     * The callbacks are called from the watchdog's thread.
+     */
+    int watch(Clock::duration budget, std::function<void()> onDeadline, std::function<void()> onAbandon);
+
+    /**
+     * Stop watching a task, once it returns none of its callbacks will be called.
+     */
+    void unwatch(int entry);
+};
+
+#endif //SHIPPROJECT_WATCHDOG_H
@@ -2,7 +2,7 @@
 #include "Simulator.h"
 
 enum PathType {
-    Travel, Algo, Output, NumThreads, None
+    Travel, Algo, Output, NumThreads, Pipeline, Lockstep, Shard, Merge, Processes, TimeBudget, AlgoTimeBudget, MaxPairErrors, Export, LogLevelFlag, Manifest, Cache, Resume, InstructionFiles, None // None must stay last, it is the number of flags
 };
 
 PathType getTypeOfPath(const string &input) {
@@ -10,12 +10,136 @@ PathType getTypeOfPath(const string &input) {
     if (input == "-algorithm_path") return Algo;
     if (input == "-output") return Output;
     if (input == "-num_threads") return NumThreads;
+    if (input == "-pipeline") return Pipeline;
+    if (input == "-lockstep") return Lockstep;
+    if (input == "-shard") return Shard;
+    if (input == "-merge") return Merge;
+    if (input == "-processes") return Processes;
+    if (input == "-time_budget") return TimeBudget;
+    if (input == "-algo_time_budget") return AlgoTimeBudget;
+    if (input == "-max_pair_errors") return MaxPairErrors;
+    if (input == "-export") return Export;
+    if (input == "-log_level") return LogLevelFlag;
+    if (input == "-manifest") return Manifest;
+    if (input == "-cache") return Cache;
+    if (input == "-resume") return Resume;
+    if (input == "-instruction_files") return InstructionFiles;
     return None;
 
 }
 
+/**
+ * Sets @param option by the value of a true|false flag, returns false if the value is neither.
+ */
+bool parseBoolFlag(const string &flag, const string &value, bool &option) {
+    if (value == "true" || value == "false") {
+        option = value == "true";
+        return true;
+    }
+    cout << "@ FATAL ERROR: " << flag << " expects true or false." << endl;
+    return false;
+}
+
+/**
+ * Sets the shard of the run by a value of the form i/N, where 0 <= i < N. returns false if the value is invalid.
+ */
+bool parseShardFlag(const string &value, RunOptions &options) {
+    vector<string> tokens;
+    getTokens(value, "/", tokens);
+    if (tokens.size() != 2 || !isPositiveNumber(tokens[0]) || !isPositiveNumber(tokens[1]) ||
+        string2int(tokens[1]) < 1 || string2int(tokens[0]) >= string2int(tokens[1])) {
+        cout << "@ FATAL ERROR: -shard expects i/N, where 0 <= i < N." << endl;
+        return false;
+    }
+    options.shard_index = string2int(tokens[0]);
+    options.num_of_shards = string2int(tokens[1]);
+    return true;
+}
+
+/**
+ * Sets the time budgets of specific algorithms by a value of the form name=seconds,name=seconds,...
+ * returns false if the value is invalid.
+ */
+bool parseAlgoTimeBudgets(const string &value, RunOptions &options) {
+    vector<string> budgets, tokens;
+    getTokens(value, ",", budgets);
+    for (auto &budget : budgets) {
+        tokens.clear();
+        getTokens(budget, "=", tokens);
+        if (tokens.size() != 2 || tokens[0].empty() || !isPositiveNumber(tokens[1])) {
+            cout << "@ FATAL ERROR: -algo_time_budget expects algorithm=seconds pairs, separated by commas." << endl;
+            return false;
+        }
+        options.algos_time_budgets[tokens[0]] = string2int(tokens[1]);
+    }
+    return true;
+}
+
+/**
+ * Sets the level of the messages that are logged, returns false if the value is not a level.
+ */
+bool parseLogLevel(const string &value) {
+    static const map<string, LogLevel> levels = {{"debug",   LogLevel::Debug},
+                                                 {"info",    LogLevel::Info},
+                                                 {"warning", LogLevel::Warning},
+                                                 {"error",   LogLevel::Error},
+                                                 {"off",     LogLevel::Off}};
+    auto level = levels.find(value);
+    if (level == levels.end()) {
+        cout << "@ FATAL ERROR: -log_level expects debug, info, warning, error or off." << endl;
+        return false;
+    }
+    Logger::getInstance().setLevel(level->second);
+    return true;
+}
+
+/**
+ * Reads the manifest file, the pairs of the run. Each line is algorithm,travel and optionally the settings of the
+ * pair: time_budget=seconds and pipeline=true|false. Returns false if the file can't be read or a line is invalid.
+ */
+bool parseManifest(const string &path, RunOptions &options) {
+    FileHandler manifest_file(path);
+    if (manifest_file.isFailed()) {
+        cout << "@ FATAL ERROR: The manifest file " << path << " could not be opened." << endl;
+        return false;
+    }
+    vector<string> tokens, setting;
+    int line_num = 0; // Counts the entries, comments and empty lines are skipped
+    while (manifest_file.getNextLineAsTokens(tokens)) {
+        line_num++;
+        if (tokens.size() < 2 || tokens[0].empty() || tokens[1].empty()) {
+            cout << "@ FATAL ERROR: Manifest entry " << line_num << " expects algorithm,travel." << endl;
+            return false;
+        }
+        PairSettings settings;
+        for (size_t i = 2; i < tokens.size(); ++i) {
+            setting.clear();
+            getTokens(tokens[i], "=", setting);
+            bool valid = setting.size() == 2;
+            if (valid && setting[0] == "time_budget" && isPositiveNumber(setting[1]))
+                settings.time_budget = string2int(setting[1]);
+            else if (valid && setting[0] == "pipeline" && (setting[1] == "true" || setting[1] == "false"))
+                settings.pipelined_ports = setting[1] == "true";
+            else {
+                cout << "@ FATAL ERROR: Manifest entry " << line_num
+                     << " has an invalid setting, expects time_budget=seconds or pipeline=true|false." << endl;
+                return false;
+            }
+        }
+        if (!options.manifest.emplace(std::make_pair(tokens[0], tokens[1]), settings).second) {
+            cout << "@ FATAL ERROR: Manifest entry " << line_num << " lists a pair that was already listed." << endl;
+            return false;
+        }
+    }
+    if (options.manifest.empty()) {
+        cout << "@ FATAL ERROR: The manifest file lists no pairs." << endl;
+        return false;
+    }
+    return true;
+}
+
 bool initializeParameters(string &travel_path, string &algorithm_path, string &output_path, unsigned int &num_of_threads,
-                          int num_of_params,
+                          RunOptions &options, vector<string> &merge_dirs, string &export_dir, int num_of_params,
                           char *argv[]) {
     if (num_of_params < 2 || num_of_params % 2 == 0) {
         cout << "@ FATAL ERROR: Wrong number of arguments was given." << endl;
@@ -47,13 +171,86 @@ bool initializeParameters(string &travel_path, string &algorithm_path, string &o
                     num_of_threads = (unsigned int)string2int(argv[i + 1]);
                 break;
             }
+            case Pipeline: {
+                if (!parseBoolFlag(argv[i], argv[i + 1], options.pipelined_ports)) return false;
+                break;
+            }
+            case Lockstep: {
+                if (!parseBoolFlag(argv[i], argv[i + 1], options.lockstep)) return false;
+                break;
+            }
+            case Shard: {
+                if (!parseShardFlag(argv[i + 1], options)) return false;
+                break;
+            }
+            case Processes: {
+                if (!parseBoolFlag(argv[i], argv[i + 1], options.worker_processes)) return false;
+                break;
+            }
+            case TimeBudget: {
+                if (!isPositiveNumber(argv[i + 1])) {
+                    cout << "@ FATAL ERROR: Time budget given is invalid." << endl;
+                    return false;
+                }
+                options.time_budget = string2int(argv[i + 1]);
+                break;
+            }
+            case AlgoTimeBudget: {
+                if (!parseAlgoTimeBudgets(argv[i + 1], options)) return false;
+                break;
+            }
+            case MaxPairErrors: {
+                if (!isPositiveNumber(argv[i + 1])) {
+                    cout << "@ FATAL ERROR: Max pair errors given is invalid." << endl;
+                    return false;
+                }
+                options.max_pair_errors = string2int(argv[i + 1]);
+                break;
+            }
+            case Merge: {
+                if (!merge_dirs.empty()) return false; //merge_dirs was already initialized
+                getTokens(argv[i + 1], ",", merge_dirs); // The output folders of the shards, separated by commas
+                break;
+            }
+            case Export: {
+                if (!export_dir.empty()) return false; //export_dir was already initialized
+                export_dir = argv[i + 1]; // The output folder of a previous run
+                break;
+            }
+            case LogLevelFlag: {
+                if (!parseLogLevel(argv[i + 1])) return false;
+                break;
+            }
+            case Manifest: {
+                if (!options.manifest.empty()) return false; //manifest was already initialized
+                if (!parseManifest(argv[i + 1], options)) return false;
+                break;
+            }
+            case Cache: {
+                if (!options.cache_dir.empty()) return false; //cache_dir was already initialized
+                options.cache_dir = argv[i + 1]; // Shared by the runs, the unchanged pairs are taken from it
+                break;
+            }
+            case Resume: {
+                if (!output_path.empty()) {
+                    cout << "@ FATAL ERROR: -resume goes on in the output folder of the run, -output can't be given." << endl;
+                    return false;
+                }
+                options.resume = true;
+                output_path = argv[i + 1]; // The output folder of the interrupted run, which has its journal
+                break;
+            }
+            case InstructionFiles: {
+                if (!parseBoolFlag(argv[i], argv[i + 1], options.instruction_files)) return false;
+                break;
+            }
             case None: {
                 cout << "@ FATAL ERROR: Invalid parameters was given." << endl;
                 return false;
             }
         }
     }
-    if (travel_path.empty()) {
+    if (travel_path.empty() && merge_dirs.empty() && export_dir.empty()) {
         cout << "@ FATAL ERROR: No travel_path was given." << endl;
         return false; // return false if there was not -travel_path param
     }
@@ -65,20 +262,34 @@ int main(int argc, char *argv[]) {
     string algorithm_path = "";
     string output_path = "";
     unsigned int num_of_threads = 1;
+    RunOptions options;
+    vector<string> merge_dirs;
+    string export_dir;
     bool clean_run;
-    if (argc > 9) {
+    if (argc > 2 * None + 1) { // Each flag comes with a value
         cout << "@ FATAL ERROR: Too many arguments given." << endl;
         return EXIT_FAILURE;
     }
-    if (!initializeParameters(travel_path, algorithm_path, output_path, num_of_threads, argc, argv)) {
+    if (!initializeParameters(travel_path, algorithm_path, output_path, num_of_threads, options, merge_dirs, export_dir, argc,
+                              argv)) {
         // README: if any flag is declared and the path given is empty, an error will be printed and the simulation will not start.
         return EXIT_FAILURE;
     }
-    Simulator sim(output_path, num_of_threads);
-    clean_run = sim.start(algorithm_path, travel_path);
+    Simulator sim(output_path, num_of_threads, options);
+    if (!merge_dirs.empty()) { // Merge mode, the results of the shards are combined without running anything
+        clean_run = sim.mergeShards(merge_dirs);
+    } else if (!export_dir.empty()) { // Export mode, the results are exported from the store of a previous run
+        clean_run = sim.exportResultsStore(export_dir);
+    } else {
+        clean_run = sim.start(algorithm_path, travel_path);
+    }
     sim.printSimulationErrors();
     if (clean_run) {
         sim.printSimulationResults();
     }
+    if (sim.hasAbandonedTasks()) { // Threads that are stuck in algorithms can't be joined, end the process without them
+        cout.flush();
+        _exit(EXIT_SUCCESS);
+    }
     return EXIT_SUCCESS;
 }